@@ -37,6 +37,7 @@
 Context context;
 Pcb pcb;
 Stack stack;
+TimePage timepage;
 
 int main( void ) {
 
@@ -56,6 +57,7 @@ int main( void ) {
     printf( "\tState   %u\n", sizeof(State) );
     printf( "\tStatus  %u\tTime    %u\n", sizeof(Status), sizeof(Time) );
     printf( "\tQueue   %u", sizeof(Queue) );
+    printf( "\tQLink   %u", sizeof(QLink) );
     printf( "\tStack   %u\n", sizeof(Stack) );
     putchar( '\n');
 
@@ -84,13 +86,30 @@ int main( void ) {
     printf( "   context:\t%d\n", (char *)&pcb.context - (char *)&pcb );
     printf( "   stack:\t%d\n", (char *)&pcb.stack - (char *)&pcb );
     printf( "   wakeup:\t%d\n", (char *)&pcb.wakeup - (char *)&pcb );
+    printf( "   kesp:\t%d\n", (char *)&pcb.kesp - (char *)&pcb );
     printf( "   queue:\t%d\n", (char *)&pcb.queue - (char *)&pcb );
+    printf( "   qlink:\t%d\n", (char *)&pcb.qlink - (char *)&pcb );
     printf( "   exit_status:\t%d\n", (char *)&pcb.exit_status - (char *)&pcb );
+    printf( "   ring:\t%d\n", (char *)&pcb.ring - (char *)&pcb );
+    printf( "   screen:\t%d\n", (char *)&pcb.screen - (char *)&pcb );
+    printf( "   fpu:\t\t%d\n", (char *)&pcb.fpu - (char *)&pcb );
+    printf( "   hash_next:\t%d\n", (char *)&pcb.hash_next - (char *)&pcb );
+    printf( "   kids:\t%d\n", (char *)&pcb.kids - (char *)&pcb );
+    printf( "   zombies:\t%d\n", (char *)&pcb.zombies - (char *)&pcb );
+    printf( "   sib_next:\t%d\n", (char *)&pcb.sib_next - (char *)&pcb );
+    printf( "   sib_prev:\t%d\n", (char *)&pcb.sib_prev - (char *)&pcb );
+    printf( "   all_next:\t%d\n", (char *)&pcb.all_next - (char *)&pcb );
+    printf( "   all_prev:\t%d\n", (char *)&pcb.all_prev - (char *)&pcb );
     printf( "   pid:\t\t%d\n", (char *)&pcb.pid - (char *)&pcb );
     printf( "   ppid:\t%d\n", (char *)&pcb.ppid - (char *)&pcb );
     printf( "   children:\t%d\n", (char *)&pcb.children - (char *)&pcb );
     printf( "   state:\t%d\n", (char *)&pcb.state - (char *)&pcb );
     printf( "   quantum:\t%d\n",(char *)&pcb.quantum - (char *)&pcb);
+    putchar( '\n' );
+
+    printf( "Byte offsets into TimePage (%u bytes):\n", sizeof(timepage) );
+    printf( "   flags:\t%d\n",
+            (char *)&timepage.flags - (char *)&timepage );
 
     return( 0 );
 }
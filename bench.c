@@ -0,0 +1,295 @@
+/*
+** SCCS ID:	@(#)bench.c	1.1	3/30/20
+**
+** File:	bench.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	In-kernel microbenchmark implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "bench.h"
+#include "kmem.h"
+#include "queues.h"
+#include "kernel.h"
+#include "scheduler.h"
+#include "kthread.h"
+#include "fpu.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// each measurement is repeated, and the fastest run is reported, so
+// that interrupts and cache misses don't make the results wander
+
+#define	BENCH_REPS	5
+#define	BENCH_NONE	0xffffffff
+
+// operations timed in each run of the scheduler benchmark
+
+#define	BENCH_OPS	1000
+
+// how long the console output benchmark runs (in ms)
+
+#define	CBENCH_MS	250
+
+// largest ordered queue tested, and the pages needed for its entries
+
+#define	QBENCH_MAX	10000
+#define	QBENCH_PAGES	((QBENCH_MAX * sizeof(QEntry) + PAGE_SIZE - 1) \
+				/ PAGE_SIZE)
+
+// dummy processes on the ready queue in the scheduler benchmark
+
+#define	SBENCH_PROCS	8
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// an entry in an ordered queue
+
+typedef struct qentry_s {
+    QLink link;
+    uint32 key;
+} QEntry;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+static QEntry *_entries;
+
+static Pcb _sbench_pcbs[ SBENCH_PROCS ];
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _least() - the smaller of a previous best time and the time since 'start'
+//
+static uint32 _least( uint32 best, uint64 start ) {
+    uint32 cycles = (uint32) (__rdtsc() - start);
+
+    return( cycles < best ? cycles : best );
+}
+
+//
+// _report() - print one result
+//
+static void _report( uint32 cycles, uint32 iters ) {
+
+    __cio_printf( " %8d", cycles / iters );
+}
+
+//
+// _qentry_cmp() - comparison function for the ordered queue benchmark
+//
+static int _qentry_cmp( const void *a, const void *b ) {
+    uint32 k1 = ((const QEntry *) a)->key;
+    uint32 k2 = ((const QEntry *) b)->key;
+
+    return( k1 < k2 ? -1 : (k1 > k2 ? 1 : 0) );
+}
+
+//
+// _bench_order() - time filling and then emptying an ordered queue
+//
+// Reports the cycles per insertion and per removal.
+//
+static void _bench_order( Queue q, uint32 n ) {
+    uint32 seed = 12345;
+    uint32 best_enq = BENCH_NONE;
+    uint32 best_deq = BENCH_NONE;
+
+    // the same keys every time
+    for( uint32 i = 0; i < n; ++i ) {
+        seed = seed * 1103515245 + 12345;
+        _entries[i].key = seed >> 8;
+    }
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        uint64 start = __rdtsc();
+        for( uint32 i = 0; i < n; ++i ) {
+            _queue_enque( q, &_entries[i] );
+        }
+        best_enq = _least( best_enq, start );
+
+        start = __rdtsc();
+        while( _queue_deque(q) != NULL ) {
+            ;
+        }
+        best_deq = _least( best_deq, start );
+    }
+
+    _report( best_enq, n );
+    _report( best_deq, n );
+}
+
+//
+// _bench_queue() - compare the sorted list and heap queue organizations
+//
+static void _bench_queue( void ) {
+
+    Queue sorted = _queue_alloc_sorted( _qentry_cmp, QOFFSET(QEntry,link) );
+    Queue heap = _queue_alloc( _qentry_cmp, QOFFSET(QEntry,link) );
+
+    if( sorted == NULL || heap == NULL ) {
+        __cio_puts( "bench: can't allocate queues\n" );
+    } else {
+        // entries start out unlinked, and are unlinked again when
+        // each run empties its queue
+        __memclr( _entries, QBENCH_MAX * sizeof(QEntry) );
+
+        __cio_puts( "cycles/op    entries   sorted:   enque    deque"
+                    "    heap:   enque    deque\n" );
+
+        for( uint32 n = 10; n <= QBENCH_MAX; n *= 10 ) {
+            __cio_printf( "         %8d        ", n );
+            _bench_order( sorted, n );
+            __cio_puts( "         " );
+            _bench_order( heap, n );
+            __cio_putchar( '\n' );
+        }
+    }
+
+    if( sorted != NULL ) {
+        _queue_free( sorted );
+    }
+    if( heap != NULL ) {
+        _queue_free( heap );
+    }
+}
+
+//
+// _bench_sched() - time the schedule/dispatch cycle
+//
+// Each cycle is what happens when the current process is preempted:
+// it is put on the ready queue, and the next ready process becomes
+// current.  The cycles are run on private ready queues holding dummy
+// PCBs, which are never given the CPU; interrupts stay disabled until
+// the real queues and current process have been put back.
+//
+static void _bench_sched( void ) {
+    Queue ready = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    Queue kready = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    uint32 best = BENCH_NONE;
+
+    if( ready == NULL || kready == NULL ) {
+        __cio_puts( "bench: can't allocate queue\n" );
+        if( ready != NULL ) {
+            _queue_free( ready );
+        }
+        if( kready != NULL ) {
+            _queue_free( kready );
+        }
+        return;
+    }
+
+    __memclr( _sbench_pcbs, sizeof(_sbench_pcbs) );
+
+    uint32 flags = __get_flags();
+    __cli();
+
+    Pcb *saved = _current;
+    Queue saved_ready = _ready;
+    Queue saved_kready = _kready;
+
+    _ready = ready;
+    _kready = kready;
+    _current = &_sbench_pcbs[0];
+    for( uint32 i = 1; i < SBENCH_PROCS; ++i ) {
+        _schedule( &_sbench_pcbs[i] );
+    }
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        uint64 start = __rdtsc();
+        for( uint32 i = 0; i < BENCH_OPS; ++i ) {
+            _schedule( _current );
+            _dispatch();
+        }
+        best = _least( best, start );
+    }
+
+    // put things back the way they were
+    while( _queue_deque(ready) != NULL ) {
+        ;
+    }
+    _ready = saved_ready;
+    _kready = saved_kready;
+    _current = saved;
+    _fpu_switch( saved );
+
+    __set_flags( flags );
+
+    _queue_free( ready );
+    _queue_free( kready );
+
+    __cio_printf( "cycles/op  schedule+dispatch (%d ready)", SBENCH_PROCS );
+    _report( best, BENCH_OPS );
+    __cio_putchar( '\n' );
+}
+
+//
+// _bench_cio() - measure the console output rate
+//
+// Full lines are written for CBENCH_MS, so every line also scrolls
+// the console; the count of characters written gives the rate.
+//
+static void _bench_cio( void ) {
+    static const char line[] =
+        "console benchmark: the quick brown fox jumps over the lazy "
+        "dog 0123456789 abcd\n";
+    const uint32 len = sizeof(line) - 1;
+    uint32 chars = 0;
+    Time begin = _system_time;
+    uint64 start = __rdtsc();
+    uint32 ms;
+
+    do {
+        __cio_write( line, len );
+        chars += len;
+        ms = (uint32) (_system_time - begin);
+    } while( ms < CBENCH_MS );
+
+    uint32 cycles = (uint32) (__rdtsc() - start);
+
+    __cio_printf( "console: %d chars in %d ms, %d chars/sec, cycles/char",
+                  chars, ms, chars / ms * 1000 + chars % ms * 1000 / ms );
+    _report( cycles, chars );
+    __cio_putchar( '\n' );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _bench_run() - run the benchmarks and print the results
+//
+void _bench_run( void ) {
+
+    __cio_putchar( '\n' );
+    _bench_cio();
+    _bench_sched();
+
+    _entries = (QEntry *) _kalloc_page( QBENCH_PAGES );
+
+    if( _entries == NULL ) {
+        __cio_puts( "bench: can't allocate queue entries\n" );
+    } else {
+        _bench_queue();
+        // multi-page blocks must be released a page at a time
+        for( uint32 i = 0; i < QBENCH_PAGES; ++i ) {
+            _kfree_page( (uint8 *) _entries + i * PAGE_SIZE );
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+** SCCS ID:	@(#)bench.h	1.1	3/30/20
+**
+** File:	bench.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	In-kernel microbenchmark declarations
+**
+** The benchmarks are run from the console shell.  They cover console
+** output, the schedule/dispatch cycle, and ordered queues; FIFO queues,
+** ring buffers, __sprint(), and the memory and string routines are
+** measured by the hosted test program instead (see hosttest.h).  Each
+** one times a routine with the TSC over a fixed number of operations
+** (or a fixed time), and reports the average number of cycles per
+** call.  Every measurement is repeated
+** and the fastest run is reported, and all inputs are generated the
+** same way each time, so the numbers from one run can be compared
+** with those from another.
+*/
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Prototypes
+*/
+
+//
+// _bench_run() - run the benchmarks and print the results
+//
+void _bench_run( void );
+
+#endif
+
+#endif
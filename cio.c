@@ -25,6 +25,7 @@
 
 #include "cio.h"
 #include "klib.h"
+#include "ring.h"
 #include "support.h"
 #include "x86arch.h"
 #include "x86pic.h"
@@ -52,31 +53,154 @@ static void (*__c_notify)(int);
 #include <stdio.h>
 #define	__cio_putchar	putchar
 #define	__cio_puts(x)	fputs( x, stdout )
+#define	__c_putchar	putchar
+#define	__c_puts(x)	fputs( x, stdout )
 #endif
 
-#define	VIDEO_ADDR(x,y)	( unsigned short * ) \
-		( VIDEO_BASE_ADDR + 2 * ( (y) * SCREEN_X_SIZE + (x) ) )
+/*
+** All output goes into a shadow copy of the screen in ordinary
+** memory, with one bit per line in __c_dirty marking the lines which
+** have changed since the last __cio_flush().  The clock ISR calls
+** __cio_flush() periodically to copy those lines to the display, so
+** the cost of updating the screen is bounded no matter how much
+** output is being produced.
+*/
+#define	SCREEN_CELLS	( SCREEN_X_SIZE * SCREEN_Y_SIZE )
+#define	ALL_LINES	( ( 1 << SCREEN_Y_SIZE ) - 1 )
+
+static unsigned short		__c_shadow[ SCREEN_CELLS ];
+static volatile unsigned int	__c_dirty;
+
+#define	VIDEO_ADDR(x,y)	( __c_shadow + (y) * SCREEN_X_SIZE + (x) )
+
+/*
+** The text-mode display memory holds VIDEO_CELLS character cells.
+** The screen shows the SCREEN_CELLS of them which begin at cell
+** __c_origin; this only moves away from the start of the memory when
+** hardware scrolling (CIO_HW_SCROLL) is in use, in which case
+** __c_scrolled counts the lines scrolled since the last flush.
+*/
+#define	VIDEO_CELLS	0x4000
+static unsigned int	__c_origin;
+#ifdef CIO_HW_SCROLL
+static unsigned int	__c_scrolled;
+#endif
+
+#define	DISPLAY_ADDR(y)	( unsigned short * ) \
+		( VIDEO_BASE_ADDR + \
+		  2 * ( __c_origin + (y) * SCREEN_X_SIZE ) )
+
+/*
+** While a program's own screen is being shown (see __cio_show()),
+** __cio_flush() copies it to the display in place of the shadow.  The
+** program updates it with ordinary stores, so the lines which have
+** changed are found by comparing it with __c_shown, a copy of what is
+** on the display; __c_redraw forces every line to be copied.
+*/
+static unsigned short		*__c_screen;
+static unsigned short		__c_shown[ SCREEN_CELLS ];
+static unsigned int		__c_redraw;
+
+// a blank cell (white on black), and two of them for 32-bit fills
+
+#define	BLANK		( ' ' | 0x0700 )
+#define	BLANK2		( BLANK | ( BLANK << 16 ) )
+
+/*
+** CRTC registers for the display start address and the cursor
+*/
+#define	CRTC_INDEX	0x3d4
+#define	CRTC_DATA	0x3d5
+#define	CRTC_START_HI	0x0c
+#define	CRTC_START_LO	0x0d
+#define	CRTC_CURSOR_HI	0x0e
+#define	CRTC_CURSOR_LO	0x0f
+
+// where the cursor belongs on the screen, and the display memory cell
+// the hardware cursor was last put on (none, initially)
+
+static unsigned int	__c_curpos;
+static unsigned int	__c_cursor = 0xffffffff;
 
 /*
 ** Support routines.
 **
-** __c_putchar_at: physical output to the video memory
+** __c_putchar_at: physical output to the shadow screen
 ** __c_setcursor: set the cursor location (screen coordinates)
+** __c_blank: fill a run of cells with blanks
+** __c_move: copy a run of cells; the runs may overlap
+** __c_touch: mark a range of lines as changed
+** __c_block/__c_unblock: keep __cio_flush() out of an update
 */
 static void __c_setcursor( void ){
-	unsigned addr;
 	unsigned int	y = curr_y;
 
 	if( y > scroll_max_y ){
 		y = scroll_max_y;
 	}
 
-	addr = (unsigned)( y * SCREEN_X_SIZE + curr_x );
+	// the hardware cursor is moved by the next __cio_flush()
+	__c_curpos = y * SCREEN_X_SIZE + curr_x;
+}
+
+static void __c_blank( unsigned short *to, unsigned int n ){
+	if( n & 1 ){
+		*to++ = BLANK;
+	}
+	n >>= 1;
+	__asm__ __volatile__( "cld; rep stosl"
+		: "+D" (to), "+c" (n)
+		: "a" (BLANK2)
+		: "memory" );
+}
+
+static void __c_move( unsigned short *to, unsigned short *from,
+		      unsigned int n ){
+	if( to <= from ){
+		if( n & 1 ){
+			*to++ = *from++;
+		}
+		n >>= 1;
+		__asm__ __volatile__( "cld; rep movsl"
+			: "+D" (to), "+S" (from), "+c" (n)
+			:
+			: "memory" );
+	} else {
+		// copy from the end, so the source isn't overwritten first;
+		// callers hold __c_block(), so no ISR runs with DF set
+		to += n - 1;
+		from += n - 1;
+		__asm__ __volatile__( "std; rep movsw; cld"
+			: "+D" (to), "+S" (from), "+c" (n)
+			:
+			: "memory" );
+	}
+}
+
+static void __c_touch( unsigned int first, unsigned int last ){
+	unsigned int	bits = ( ( 2u << last ) - 1 ) & ~( ( 1u << first ) - 1 );
+
+	/*
+	** This must follow the change to the shadow screen.  A single
+	** 'orl' can't be split by an interrupt, so no line marked here
+	** can be lost to a __cio_flush() from an ISR.
+	*/
+	__asm__ __volatile__( "orl %1, %0"
+		: "+m" (__c_dirty)
+		: "r" (bits) );
+}
+
+static unsigned int __c_block( void ){
+	unsigned int	flags = __get_flags();
 
-	__outb( 0x3d4, 0xe );
-	__outb( 0x3d5, ( addr >> 8 ) & 0xff );
-	__outb( 0x3d4, 0xf );
-	__outb( 0x3d5, addr & 0xff );
+	__asm__ __volatile__( "cli" );
+	return flags;
+}
+
+static void __c_unblock( unsigned int flags ){
+	if( flags & EFLAGS_IF ){
+		__asm__ __volatile__( "sti" );
+	}
 }
 
 static void __c_putchar_at( unsigned int x, unsigned int y, unsigned int c ){
@@ -97,6 +221,7 @@ static void __c_putchar_at( unsigned int x, unsigned int y, unsigned int c ){
 			*/
 			*addr = (unsigned short)c | 0x0700;
 		}
+		__c_touch( y, y );
 	}
 }
 
@@ -141,9 +266,9 @@ void __cio_putchar_at( unsigned int x, unsigned int y, unsigned int c ){
 		else {
 			limit = scroll_min_x - 1;
 		}
-		while( x <= limit ){
-			__c_putchar_at( x, y, ' ' );
-			x += 1;
+		if( x <= limit && y <= max_y ){
+			__c_blank( VIDEO_ADDR( x, y ), limit - x + 1 );
+			__c_touch( y, y );
 		}
 	}
 	else {
@@ -152,7 +277,11 @@ void __cio_putchar_at( unsigned int x, unsigned int y, unsigned int c ){
 }
 
 #ifndef SA_DEBUG
-void __cio_putchar( unsigned int c ){
+/*
+** __c_putchar() does everything but move the hardware cursor, so
+** that routines which write whole strings need only move it once
+*/
+static void __c_putchar( unsigned int c ){
 	/*
 	** If we're off the bottom of the screen, scroll the window.
 	*/
@@ -167,9 +296,10 @@ void __cio_putchar( unsigned int c ){
 		** Erase to the end of the line, then move to new line
 		** (actual scroll is delayed until next output appears).
 		*/
-		while( curr_x <= scroll_max_x ){
-			__c_putchar_at( curr_x, curr_y, ' ' );
-			curr_x += 1;
+		if( curr_x <= scroll_max_x ){
+			__c_blank( VIDEO_ADDR( curr_x, curr_y ),
+				   scroll_max_x - curr_x + 1 );
+			__c_touch( curr_y, curr_y );
 		}
 		curr_x = scroll_min_x;
 		curr_y += 1;
@@ -179,6 +309,15 @@ void __cio_putchar( unsigned int c ){
 		curr_x = scroll_min_x;
 		break;
 
+	case '\b':
+		/*
+		** Back up, but not past the start of the line.
+		*/
+		if( curr_x > scroll_min_x ){
+			curr_x -= 1;
+		}
+		break;
+
 	default:
 		__c_putchar_at( curr_x, curr_y, c );
 		curr_x += 1;
@@ -188,6 +327,10 @@ void __cio_putchar( unsigned int c ){
 		}
 		break;
 	}
+}
+
+void __cio_putchar( unsigned int c ){
+	__c_putchar( c );
 	__c_setcursor();
 }
 #endif
@@ -205,13 +348,18 @@ void __cio_puts_at( unsigned int x, unsigned int y, char *str ){
 }
 
 #ifndef SA_DEBUG
-void __cio_puts( char *str ){
+static void __c_puts( char *str ){
 	unsigned int	ch;
 
 	while( (ch = *str++) != '\0' ){
-		__cio_putchar( ch );
+		__c_putchar( ch );
 	}
 }
+
+void __cio_puts( char *str ){
+	__c_puts( str );
+	__c_setcursor();
+}
 #endif
 
 /*
@@ -219,40 +367,41 @@ void __cio_puts( char *str ){
 */
 void __cio_write( const char *buf, int length ) {
     for( int i = 0; i < length; ++i ) {
-        __cio_putchar( buf[i] );
+        __c_putchar( buf[i] );
     }
+    __c_setcursor();
 }
 
 void __cio_clearscroll( void ){
 	unsigned int	nchars = scroll_max_x - scroll_min_x + 1;
 	unsigned int	l;
-	unsigned int	c;
 
-	for( l = scroll_min_y; l <= scroll_max_y; l += 1 ){
-		unsigned short *to = VIDEO_ADDR( scroll_min_x, l );
-
-		for( c = 0; c < nchars; c += 1 ){
-			*to++ = ' ' | 0x0700;
+	/*
+	** A region as wide as the screen is one block of cells.
+	*/
+	if( nchars == SCREEN_X_SIZE ){
+		__c_blank( VIDEO_ADDR( scroll_min_x, scroll_min_y ),
+			   ( scroll_max_y - scroll_min_y + 1 ) * nchars );
+	} else {
+		for( l = scroll_min_y; l <= scroll_max_y; l += 1 ){
+			__c_blank( VIDEO_ADDR( scroll_min_x, l ), nchars );
 		}
 	}
+	__c_touch( scroll_min_y, scroll_max_y );
 }
 
 void __cio_clearscreen( void ){
 	unsigned short *to = VIDEO_ADDR( min_x, min_y );
 	unsigned int	nchars = ( max_y - min_y + 1 ) * ( max_x - min_x + 1 );
 
-	while( nchars > 0 ){
-		*to++ = ' ' | 0x0700;
-		nchars -= 1;
-	}
+	__c_blank( to, nchars );
+	__c_touch( min_y, max_y );
 }
 
-
 void __cio_scroll( unsigned int lines ){
-	unsigned short *from;
-	unsigned short *to;
-	int	nchars = scroll_max_x - scroll_min_x + 1;
-	int	line, c;
+	unsigned int	nchars = scroll_max_x - scroll_min_x + 1;
+	unsigned int	line;
+	unsigned int	flags;
 
 	/*
 	** If # of lines is the whole scrolling region or more, just clear.
@@ -266,22 +415,182 @@ void __cio_scroll( unsigned int lines ){
 	}
 
 	/*
-	** Must copy it line by line.
+	** The shadow screen and the changed-line bits must move together,
+	** or a flush in between could put lines in the wrong place.
 	*/
-	for( line = scroll_min_y; line <= scroll_max_y - lines; line += 1 ){
-		from = VIDEO_ADDR( scroll_min_x, line + lines );
-		to = VIDEO_ADDR( scroll_min_x, line );
-		for( c = 0; c < nchars; c += 1 ){
-			*to++ = *from++;
+	flags = __c_block();
+
+	/*
+	** A region as wide as the screen moves as one block, which
+	** overlaps itself (so __memcpy() can't be used); otherwise, it
+	** must be copied line by line.
+	*/
+	if( nchars == SCREEN_X_SIZE ){
+		__c_move( VIDEO_ADDR( scroll_min_x, scroll_min_y ),
+			  VIDEO_ADDR( scroll_min_x, scroll_min_y + lines ),
+			  ( scroll_max_y - scroll_min_y + 1 - lines )
+			  * nchars );
+		__c_blank( VIDEO_ADDR( scroll_min_x, scroll_max_y - lines + 1 ),
+			   lines * nchars );
+	} else {
+		for( line = scroll_min_y; line <= scroll_max_y - lines;
+		     line += 1 ){
+			__c_move( VIDEO_ADDR( scroll_min_x, line ),
+				  VIDEO_ADDR( scroll_min_x, line + lines ),
+				  nchars );
+		}
+		for( ; line <= scroll_max_y; line += 1 ){
+			__c_blank( VIDEO_ADDR( scroll_min_x, line ), nchars );
+		}
+	}
+
+#ifdef CIO_HW_SCROLL
+	/*
+	** When the whole screen scrolls, the next flush moves the display
+	** start address instead of rewriting every line; the lines which
+	** had changed move up with their contents.
+	*/
+	if( scroll_min_x == SCREEN_MIN_X && scroll_max_x == SCREEN_MAX_X &&
+	    scroll_min_y == SCREEN_MIN_Y && scroll_max_y == SCREEN_MAX_Y ){
+		__c_scrolled += lines;
+		__c_dirty = ( __c_dirty >> lines ) |
+			    ( ALL_LINES & ~( ALL_LINES >> lines ) );
+		__c_unblock( flags );
+		return;
+	}
+#endif
+
+	__c_touch( scroll_min_y, scroll_max_y );
+	__c_unblock( flags );
+}
+
+static void __c_flush_screen( void ){
+	unsigned int	addr = __c_origin + SCREEN_CELLS;
+	unsigned int	y;
+
+	for( y = 0; y < SCREEN_Y_SIZE; y += 1 ){
+		unsigned int	*from = ( unsigned int * )
+			( __c_screen + y * SCREEN_X_SIZE );
+		unsigned int	*shown = ( unsigned int * )
+			( __c_shown + y * SCREEN_X_SIZE );
+		unsigned int	i = 0;
+
+		if( !__c_redraw ){
+			while( i < SCREEN_X_SIZE / 2 && from[i] == shown[i] ){
+				i += 1;
+			}
+			if( i == SCREEN_X_SIZE / 2 ){
+				continue;
+			}
+		}
+		__memcpy( shown, from, SCREEN_X_SIZE * 2 );
+		__memcpy( DISPLAY_ADDR( y ), shown, SCREEN_X_SIZE * 2 );
+	}
+	__c_redraw = 0;
+
+	/*
+	** The program draws its own cursor, if it wants one; park the
+	** hardware cursor just past the end of the screen.
+	*/
+	if( addr != __c_cursor ){
+		__c_cursor = addr;
+		__outb( CRTC_INDEX, CRTC_CURSOR_HI );
+		__outb( CRTC_DATA, ( addr >> 8 ) & 0xff );
+		__outb( CRTC_INDEX, CRTC_CURSOR_LO );
+		__outb( CRTC_DATA, addr & 0xff );
+	}
+}
+
+void __cio_show( unsigned short *screen ){
+	unsigned int	flags = __c_block();
+
+	__c_screen = screen;
+	if( screen ){
+		__c_redraw = 1;
+	} else {
+		// the console's output has been hidden; show all of it
+		__c_dirty = ALL_LINES;
+	}
+
+	__c_unblock( flags );
+}
+
+void __cio_flush( void ){
+	unsigned int	flags = __c_block();
+	unsigned int	dirty = __c_dirty;
+	unsigned int	addr;
+	unsigned int	first;
+	unsigned int	y;
+
+	if( __c_screen ){
+		/*
+		** The console's changes (and any hardware scrolling)
+		** wait until it is being shown again.
+		*/
+		__c_flush_screen();
+		__c_unblock( flags );
+		return;
+	}
+
+	__c_dirty = 0;
+
+#ifdef CIO_HW_SCROLL
+	if( __c_scrolled > 0 ){
+		unsigned int	shift = __c_scrolled * SCREEN_X_SIZE;
+
+		if( __c_scrolled < SCREEN_Y_SIZE &&
+		    __c_origin + shift + SCREEN_CELLS <= VIDEO_CELLS ){
+			__c_origin += shift;
+		} else {
+			/*
+			** Out of display memory; start over at the
+			** beginning, and redraw everything there.
+			*/
+			__c_origin = 0;
+			dirty = ALL_LINES;
 		}
+		__c_scrolled = 0;
+
+		__outb( CRTC_INDEX, CRTC_START_HI );
+		__outb( CRTC_DATA, ( __c_origin >> 8 ) & 0xff );
+		__outb( CRTC_INDEX, CRTC_START_LO );
+		__outb( CRTC_DATA, __c_origin & 0xff );
 	}
+#endif
 
-	for( ; line <= scroll_max_y; line += 1 ){
-		to = VIDEO_ADDR( scroll_min_x, line );
-		for( c = 0; c < nchars; c += 1 ){
-			*to++ = ' ' | 0x0700;
+	/*
+	** Copy each run of changed lines as one block.
+	*/
+	y = 0;
+	while( dirty != 0 ){
+		if( ( dirty & 1 ) == 0 ){
+			dirty >>= 1;
+			y += 1;
+			continue;
 		}
+		first = y;
+		while( dirty & 1 ){
+			dirty >>= 1;
+			y += 1;
+		}
+		__memcpy( DISPLAY_ADDR( first ), VIDEO_ADDR( 0, first ),
+			  ( y - first ) * SCREEN_X_SIZE * 2 );
+	}
+
+	/*
+	** Each CRTC register access is a slow I/O cycle, so leave the
+	** cursor alone if it is already in the right place.
+	*/
+	addr = __c_origin + __c_curpos;
+	if( addr != __c_cursor ){
+		__c_cursor = addr;
+		__outb( CRTC_INDEX, CRTC_CURSOR_HI );
+		__outb( CRTC_DATA, ( addr >> 8 ) & 0xff );
+		__outb( CRTC_INDEX, CRTC_CURSOR_LO );
+		__outb( CRTC_DATA, addr & 0xff );
 	}
+
+	__c_unblock( flags );
 }
 
 static int pad( int x, int y, int extra, int padchar ){
@@ -291,7 +600,7 @@ static int pad( int x, int y, int extra, int padchar ){
 			x += 1;
 		}
 		else {
-			__cio_putchar( padchar );
+			__c_putchar( padchar );
 		}
 		extra -= 1;
 	}
@@ -314,7 +623,7 @@ static int padstr( int x, int y, char *str, int len, int width,
 		x += len;
 	}
 	else {
-		__cio_puts( str );
+		__c_puts( str );
 	}
 	if( extra > 0 && leftadjust ){
 		x = pad( x, y, extra, padchar );
@@ -420,7 +729,7 @@ static void __c_do_printf( int x, int y, char **f ){
 				}
 			}
 			else {
-				__cio_putchar( ch );
+				__c_putchar( ch );
 			}
 		}
 	}
@@ -432,6 +741,7 @@ void __cio_printf_at( unsigned int x, unsigned int y, char *fmt, ... ){
 
 void __cio_printf( char *fmt, ... ){
 	__c_do_printf( -1, -1, &fmt );
+	__c_setcursor();
 }
 
 static unsigned char scan_code[ 2 ][ 128 ] = {
@@ -474,27 +784,23 @@ static unsigned char scan_code[ 2 ][ 128 ] = {
 	}
 };
 
-#define	C_BUFSIZE	200
+#define	C_BUFSIZE	256	/* must be a power of two */
 #define	KEYBOARD_DATA	0x60
 #define	KEYBOARD_STATUS	0x64
 #define	READY		0x1
 
 /*
-** Circular buffer for input characters.  Characters are inserted at
-** __c_next_space, and are removed at __c_next_char.  Buffer is empty if
-** these are equal.
+** Ring buffer for input characters.  The keyboard ISR adds characters,
+** and __cio_getchar() removes them.  (When interrupts are disabled,
+** __cio_getchar() adds them itself, so there is still only one
+** producer at a time.)  This is initialized statically so that it
+** works before __cio_init() is called.
 */
 static volatile bool ignore_kbint = false;
 static	char	__c_input_buffer[ C_BUFSIZE ];
-static	volatile char	*__c_next_char = __c_input_buffer;
-static	volatile char	*__c_next_space = __c_input_buffer;
-
-static	volatile char *__c_increment( volatile char *pointer ){
-	if( ++pointer >= __c_input_buffer + C_BUFSIZE ){
-		pointer = __c_input_buffer;
-	}
-	return pointer;
-}
+static	Ring	__c_input = {
+	0, 0, C_BUFSIZE - 1, (uint8 *) __c_input_buffer
+};
 
 static int __c_input_scan_code( int code ){
 	static	int	shift = 0;
@@ -533,16 +839,11 @@ static int __c_input_scan_code( int code ){
 		if( ( code & 0x80 ) == 0 ){
 			code = scan_code[ shift ][ (int)code ];
 			if( code != '\377' ){
-				volatile char	*next = __c_increment( __c_next_space );
-
 				/*
 				** Store character only if there's room
 				*/
 				rval = code & ctrl_mask;
-				if( next != __c_next_char ){
-					*__c_next_space = code & ctrl_mask;
-					__c_next_space = next;
-				}
+				(void) __ring_put( &__c_input, rval );
 			}
 		}
 	}
@@ -577,8 +878,14 @@ int __cio_getchar( void ){
 	char	c;
 	int	interrupts_enabled = __get_flags() & EFLAGS_IF;
 
-	while( __c_next_char == __c_next_space ){
+	while( __ring_count( &__c_input ) == 0 ){
 		if( !interrupts_enabled ){
+			/*
+			** The clock isn't updating the screen, so make
+			** sure any prompt can be seen.
+			*/
+			__cio_flush();
+
 			/*
 			** Must read the next keystroke ourselves.
 			*/
@@ -590,8 +897,7 @@ int __cio_getchar( void ){
 		}
 	}
 
-	c = *__c_next_char & 0xff;
-	__c_next_char = __c_increment( __c_next_char );
+	c = __ring_get( &__c_input );
 	if( c != EOT ){
 		__cio_putchar( c );
 	}
@@ -599,6 +905,10 @@ int __cio_getchar( void ){
 	return c;
 }
 
+int __cio_takechar( void ){
+	return __ring_get( &__c_input );
+}
+
 int __cio_gets( char *buffer, unsigned int size ){
 	char	ch;
 	int	count = 0;
@@ -622,14 +932,17 @@ int __cio_gets( char *buffer, unsigned int size ){
 /**
   * Print the contents of the cio input buffer.
   * This function creates two lines of output: the first is the contents
-  * of the buffer. The line below shows where the _c_next_char and 
-  * __c_next_space pointers are. 
+  * of the buffer. The line below shows where the ring's head (next
+  * space) and tail (next char) indices are.
   *
-  * ^ = __c_next_char
-  * _ = __c_next_space
-  * & = Both pointers point to the same location
+  * ^ = next char
+  * _ = next space
+  * & = Both indices refer to the same location
   */
 void __cio_dump_queue( void ) {
+    unsigned int next_char = __c_input.tail & __c_input.mask;
+    unsigned int next_space = __c_input.head & __c_input.mask;
+
     __cio_printf("QUEUE CONTENTS [%d]:\n", __cio_input_queue());
     for (int i = 0; i < C_BUFSIZE; ++i) {
         __cio_printf("%c", __c_input_buffer[i]);
@@ -637,12 +950,11 @@ void __cio_dump_queue( void ) {
     __cio_printf("\n");
 
     for (int i = 0; i < C_BUFSIZE; ++i) {
-        if (&__c_input_buffer[i] == __c_next_space &&
-            &__c_input_buffer[i] == __c_next_char) {
+        if (i == next_space && i == next_char) {
             __cio_printf("&");
-        } else if (&__c_input_buffer[i] == __c_next_space) {
+        } else if (i == next_space) {
             __cio_printf("_");
-        } else if (&__c_input_buffer[i] == __c_next_char) {
+        } else if (i == next_char) {
             __cio_printf("^");
         } else {
             __cio_printf(" ");
@@ -652,12 +964,7 @@ void __cio_dump_queue( void ) {
 }
 
 int __cio_input_queue( void ){
-	int	n_chars = __c_next_space - __c_next_char;
-
-	if( n_chars < 0 ){
-		n_chars += C_BUFSIZE;
-	}
-	return n_chars;
+	return __ring_count( &__c_input );
 }
 
 /*
@@ -680,6 +987,11 @@ void __cio_init( void (*fcn)(int) ){
 	scroll_max_x = SCREEN_MAX_X;
 	scroll_max_y = SCREEN_MAX_Y;
 
+	/*
+	** Start the shadow screen with whatever is being displayed
+	*/
+	__memcpy( __c_shadow, DISPLAY_ADDR( 0 ), sizeof(__c_shadow) );
+
 	/*
 	** Initial cursor location
 	*/
@@ -32,6 +32,10 @@
 **	as (column,row), with the upper left corner of the screen being
 **	(0,0) and the lower right corner being (79,24).
 **
+**	Both families write into a copy of the screen in memory; the
+**	changed lines are copied to the display by __cio_flush(), which
+**	the clock ISR calls every CIO_REFRESH_MS milliseconds.
+**
 **	The printf provided in both sets of functions has the same
 **	conversion capabilities.  Format codes are of the form:
 **
@@ -61,6 +65,11 @@
 // EOT indicator (control-D)
 #define EOT '\04'
 
+// interval between screen refreshes (in ms)
+#ifndef CIO_REFRESH_MS
+#define	CIO_REFRESH_MS	20
+#endif
+
 /*
 ** Name:	__cio_init
 **
@@ -70,6 +79,29 @@
 */
 void __cio_init( void (*notify)(int) );
 
+/*
+** Name:	__cio_flush
+**
+** Description:	Copies the lines which have changed since the last call
+**		to the display, and moves the hardware cursor.  Call it
+**		before waiting with interrupts disabled, so that the
+**		latest output can be seen.
+*/
+void __cio_flush( void );
+
+/*
+** Name:	__cio_show
+**
+** Description:	Selects what the display shows: a program's own screen
+**		of 80x25 cells (character in the low byte, attribute in
+**		the high byte), which __cio_flush() will copy to the
+**		display as it changes, or (if NULL) the console output.
+**		Console output is still kept while a screen is shown,
+**		and appears again when the console is selected.
+** Arguments:	The screen to be shown, or NULL
+*/
+void __cio_show( unsigned short *screen );
+
 /*****************************************************************************
 **
 ** SCROLLING OUTPUT ROUTINES
@@ -242,6 +274,17 @@ int __cio_getchar( void );
 */
 int __cio_gets( char *buffer, unsigned int size );
 
+/*
+** Name:	__cio_takechar
+**
+** Description:	Removes the next character from the input queue, without
+**		waiting for one or echoing it.  This is for use by the
+**		notification function (or code it calls), so that the
+**		characters can be buffered elsewhere.
+** Returns:	The next character, or -1 if the input queue is empty
+*/
+int __cio_takechar( void );
+
 /*
 ** Name:	__cio_input_queue
 **
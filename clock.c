@@ -20,9 +20,13 @@
 #include "klib.h"
 
 #include "clock.h"
+#include "cons.h"
+#include "cpu_features.h"
+#include "kthread.h"
 #include "process.h"
 #include "queues.h"
 #include "scheduler.h"
+#include "sio.h"
 
 
 /*
@@ -42,20 +46,98 @@
 static uint32 _pinwheel;   // pinwheel counter
 static uint32 _pindex;     // index into pinwheel string
 
+// console refresh control
+
+static uint32 _refresh;    // ticks since the last screen refresh
+
+// TSC calibration control
+
+static bool _have_tsc;     // does this CPU have a time-stamp counter?
+static uint32 _cal_ticks;  // ticks since the last calibration point
+static uint64 _cal_tsc;    // TSC value at the last calibration point
+
 /*
 ** PUBLIC GLOBAL VARIABLES
 */
 
+// the time page
+
+TimePage *_time_page;
+
 /*
 ** PRIVATE FUNCTIONS
 */
 
+//
+// _clk_update_page() - publish the new system time
+//
+// Called once per tick.  The sequence number is odd while the page
+// is being updated; see fast_gettime() in ulibc.c for the reader side.
+//
+static void _clk_update_page( void ) {
+    uint64 now = 0;
+
+    if( _have_tsc ) {
+        now = __rdtsc();
+
+        // periodically re-measure the length of a tick in TSC cycles
+        if( ++_cal_ticks >= TSC_CALIBRATION_TICKS ) {
+            _cal_ticks = 0;
+            if( _cal_tsc != 0 ) {
+                _time_page->tsc_per_tick =
+                    ((uint32) (now - _cal_tsc)) / TSC_CALIBRATION_TICKS;
+            }
+            _cal_tsc = now;
+        }
+    }
+
+    _time_page->seq += 1;
+    _time_page->time = _system_time;
+    _time_page->tsc = now;
+    _time_page->seq += 1;
+}
+
+//
+// _clk_pinwheel() - spin the pinwheel (deferred work)
+//
+// @param index   Which pinwheel character to display
+//
+static void _clk_pinwheel( uint32 index ) {
+    __cio_putchar_at( 0, 0, "|/-\\"[ index & 3 ] );
+}
+
+#if defined(STATUS)
+//
+// _clk_status() - report system status (deferred work)
+//
+// Dumps the queue lengths and the SIO status (along with the SIO
+// buffers, if non-empty).
+//
+static void _clk_status( uint32 unused ) {
+    uint32 readers, writers;
+
+    _sio_blocked( &readers, &writers );
+    readers += _cons_blocked();
+
+    __cio_printf_at( 3, 0,
+        "%3d procs:  sl/%d wt/%d rd/%d wr/%d zo/%d  r %d  ",
+            _active,
+            _queue_length(_sleeping), _queue_length(_waiting),
+            readers, writers,
+            _queue_length(_zombie),
+            _queue_length(_ready)
+    );
+    _sio_dump( true );
+    // _active_dump( "Ptbl", false );
+}
+#endif
+
 //
 // _clk_isr() - the clock ISR
 //
-// Interrupt handler for the clock module.  Spins the pinwheel, wakes up
-// sleeping processes, and handles quantum expiration for the current
-// process.
+// Interrupt handler for the clock module.  Wakes up sleeping processes
+// and handles quantum expiration for the current process; the pinwheel
+// and status reports are left to the kernel worker thread.
 //
 static void _clk_isr( int vector, int ecode ) {
 
@@ -65,29 +147,21 @@ static void _clk_isr( int vector, int ecode ) {
     if( _pinwheel == (CLOCK_FREQUENCY / 10) ) {
         _pinwheel = 0;
         ++_pindex;
-        __cio_putchar_at( 0, 0, "|/-\\"[ _pindex & 3 ] );
+        _kthread_defer( _clk_pinwheel, _pindex );
     }
 
 #if defined(STATUS)
-    // Periodically, dump the queue lengths and the SIO status (along
-    // with the SIO buffers, if non-empty).
+    // Periodically, report on the state of the system
 
     if( (_system_time % SEC_TO_TICKS(STATUS)) == 0 ) {
-        __cio_printf_at( 3, 0,
-            "%3d procs:  sl/%d wt/%d rd/%d zo/%d  r %d     ",
-                _active_procs,
-                _queue_length(_sleeping), _queue_length(_waiting),
-                _queue_length(_reading), _queue_length(_zombie),
-                _queue_length(_ready)
-        );
-        _sio_dump( true );
-        // _active_dump( "Ptbl", false );
+        _kthread_defer( _clk_status, 0 );
     }
 #endif
 
     // time marches on
 
     ++_system_time;
+    _clk_update_page();
 
     // wake up any sleeping processes whose time has come
     //
@@ -107,15 +181,26 @@ static void _clk_isr( int vector, int ecode ) {
         pcb = _queue_front( _sleeping );
     }
 
+    // a serial read may have timed out
+    _sio_timer();
+
+    // bring the screen up to date
+
+    ++_refresh;
+    if( _refresh >= MS_TO_TICKS(CIO_REFRESH_MS) ) {
+        _refresh = 0;
+        __cio_flush();
+    }
+
     // check the current process to see if its time slice has expired
     _current->quantum -= 1;
     if( _current->quantum < 1 ) {
-        // yes!  however, if it's idle(),
-        // we don't want to schedule it
-        if( _current != _idle_pcb ) {
-            _schedule( _current );
-        }
-        _dispatch();
+        // yes!  (if we interrupted a system call, this
+        // happens when that call is finished)
+        _preempt();
+    } else {
+        // let any kernel thread with deferred work run first
+        _kthread_preempt();
     }
 
     // tell the PIC we're done
@@ -139,6 +224,16 @@ void _clk_init( void ) {
     // return to the epoch
     _system_time = 0;
 
+    // create the time page; the TSC rate is filled in by the ISR
+    // once it has been measured
+    _time_page = (TimePage *) _kalloc_page( 1 );
+    assert( _time_page );
+    __memclr( _time_page, sizeof(TimePage) );
+
+    _have_tsc = _cpu_has( CPU_TSC );
+    _cal_ticks = 0;
+    _cal_tsc = 0;
+
     // configure the clock
     divisor = TIMER_FREQUENCY / CLOCK_FREQUENCY;
     __outb( TIMER_CONTROL_PORT, TIMER_0_LOAD | TIMER_0_SQUARE );
@@ -40,6 +40,11 @@
 #define	TICKS_TO_SEC(n)		((n) / CLOCK_FREQUENCY)
 #define	TICKS_TO_SEC_ROUNDED(n)	(((n)+(CLOCK_FREQUENCY-1)) / CLOCK_FREQUENCY)
 
+// number of ticks over which the TSC rate in the time page is measured
+// (short enough that the cycle count fits comfortably in 32 bits)
+
+#define	TSC_CALIBRATION_TICKS	100
+
 /*
 ** Types
 */
@@ -48,6 +53,9 @@
 ** Globals
 */
 
+// the time page (see types.h); NULL until _clk_init() has run
+extern TimePage *_time_page;
+
 /*
 ** Prototypes
 */
@@ -30,11 +30,51 @@
 // predefined I/O channels
 
 #define	CHAN_CONS	0
-#define	CHAN_SIO	1
+#define	CHAN_SIO	1	// COM1
 
-// maximum number of processes in the system
+// each serial port is its own channel
 
-#define N_PROCS     25
+#define	CHAN_COM1	CHAN_SIO
+#define	CHAN_COM2	2
+#define	CHAN_COM3	3
+#define	CHAN_COM4	4
+
+// ioctl() requests for the serial channels; OR in IOC_GET to examine
+// a setting without changing it
+
+#define	IOC_GET		0x80000000
+
+#define	IOC_SIO_VMIN	1	// bytes needed before a read may complete
+#define	IOC_SIO_VTIME	2	// inter-byte read timeout (ms), 0 for none
+#define	IOC_SIO_BAUD	3	// data rate (bits/sec; must divide 115200)
+#define	IOC_SIO_MODE	4	// line discipline (SIO_MODE_*)
+
+// ioctl() requests for the console
+
+#define	IOC_CONS_MODE	5	// input discipline (CONS_MODE_*)
+
+// serial line disciplines
+
+#define	SIO_MODE_RAW	0	// bytes pass through untouched
+#define	SIO_MODE_COOKED	1	// CR->LF on input, LF->CRLF on output
+#define	SIO_MODE_ECHO	2	// cooked, and input is echoed
+
+// console input disciplines
+
+#define	CONS_MODE_RAW	0	// keystrokes as typed, no echo
+#define	CONS_MODE_LINE	1	// echoed and edited a line at a time
+
+// size of a screen from conmap(); each cell holds a character (low
+// byte) and its attribute (high byte)
+
+#define	CONS_COLS	80
+#define	CONS_ROWS	25
+
+// default limit on the number of processes in the system; PCBs are
+// allocated on demand, so this can be changed at run time through
+// the _proc_limit variable
+
+#define N_PROCS     256
 
 #ifndef __SP_ASM__
 
@@ -0,0 +1,454 @@
+/*
+** SCCS ID:	@(#)cons.c	1.1	3/30/20
+**
+** File:	cons.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Console input implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "cons.h"
+#include "kmem.h"
+#include "kthread.h"
+#include "process.h"
+#include "queues.h"
+#include "ring.h"
+#include "scheduler.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+#if (CONS_BUF_SIZE & (CONS_BUF_SIZE - 1)) != 0
+#error "CONS_BUF_SIZE must be a power of two"
+#endif
+
+// editing characters (line mode)
+
+#define	CONS_ERASE	'\b'
+#define	CONS_DEL	0x7f
+#define	CONS_KILL	0x15	// ^U
+
+// a blank screen cell (white on black)
+
+#define	CONS_BLANK	0x0720
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// the state of the console input
+
+typedef struct console_s {
+    uint32 mode;                  // CONS_MODE_*
+    Ring in;                      // input ready to be read
+    uint8 inbuf[ CONS_BUF_SIZE ];
+    uint32 lines;                 // lines (or ^Ds) in 'in' (line mode)
+    char line[ CONS_LINE ];       // the line being edited
+    uint32 len;                   //   and its length
+    Queue reading;                // processes waiting for input
+    bool deferred;                // has _cons_rx_work() been deferred?
+    uint32 dropped;               // characters lost for lack of room
+} Console;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+static Console _cons;
+
+// the process whose screen is being shown, or NULL for the console
+
+static Pcb *_cons_owner;
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _cons_ready() - is there input a read could return?
+//
+static bool _cons_ready( Console *c ) {
+
+    if( c->mode == CONS_MODE_RAW ) {
+        return( __ring_count(&c->in) > 0 );
+    }
+    return( c->lines > 0 );
+}
+
+//
+// _cons_take() - remove input for a read
+//
+// In line mode, this stops after a newline (which is returned) or a
+// ^D (which is not).  Must be called with interrupts disabled, and
+// only when _cons_ready() says there is input.
+//
+// @returns The number of characters put into 'buf'
+//
+static uint32 _cons_take( Console *c, char *buf, uint32 length ) {
+    uint32 n = 0;
+
+    if( c->mode == CONS_MODE_RAW ) {
+        return( __ring_read(&c->in, buf, length) );
+    }
+
+    while( n < length ) {
+        int ch = __ring_get( &c->in );
+        if( ch < 0 ) {
+            break;
+        }
+        if( ch == EOT ) {
+            --c->lines;
+            break;
+        }
+        buf[ n++ ] = ch;
+        if( ch == '\n' ) {
+            --c->lines;
+            break;
+        }
+    }
+
+    return( n );
+}
+
+//
+// _cons_rx_work() - complete reads waiting for input (deferred work)
+//
+static void _cons_rx_work( uint32 unused ) {
+    Console *c = &_cons;
+    uint32 flags = __get_flags();
+    Pcb *pcb;
+
+    __cli();
+
+    c->deferred = false;
+
+    while( _cons_ready(c) && (pcb = _queue_deque(c->reading)) != NULL ) {
+
+        // buffer is arg #2, its length arg #3; the count goes in EAX
+        RET(pcb) = _cons_take( c, (char *) ARG(pcb,2), ARG(pcb,3) );
+        _schedule( pcb );
+    }
+
+    __set_flags( flags );
+}
+
+//
+// _cons_count_lines() - count the complete lines in the input buffer
+//
+// Used when switching to line mode, as raw input may contain newlines
+// and ^Ds.
+//
+static uint32 _cons_count_lines( Console *c ) {
+    uint32 count = __ring_count( &c->in );
+    uint32 lines = 0;
+
+    for( uint32 i = 0; i < count; ++i ) {
+        int ch = __ring_peek( &c->in, i );
+        if( ch == '\n' || ch == EOT ) {
+            ++lines;
+        }
+    }
+
+    return( lines );
+}
+
+//
+// _cons_wake() - arrange to complete reads if there is input for them
+//
+// Must be called with interrupts disabled.
+//
+// @returns true if _cons_rx_work() was deferred
+//
+static bool _cons_wake( Console *c ) {
+
+    if( c->deferred || !_cons_ready(c) || _queue_length(c->reading) == 0 ) {
+        return( false );
+    }
+
+    c->deferred = true;
+    _kthread_defer( _cons_rx_work, 0 );
+
+    return( true );
+}
+
+//
+// _cons_end_line() - move the line being edited to the input buffer
+//
+// @param term  The character which ended the line ('\n' or EOT)
+//
+static void _cons_end_line( Console *c, int term ) {
+
+    if( __ring_space(&c->in) < c->len + 1 ) {
+        c->dropped += c->len + 1;
+    } else {
+        (void) __ring_write( &c->in, c->line, c->len );
+        (void) __ring_put( &c->in, term );
+        ++c->lines;
+    }
+    c->len = 0;
+}
+
+//
+// _cons_key() - process one keystroke
+//
+static void _cons_key( Console *c, int ch ) {
+
+    if( c->mode == CONS_MODE_RAW ) {
+        if( !__ring_put(&c->in, ch) ) {
+            ++c->dropped;
+        }
+        return;
+    }
+
+    switch( ch ) {
+
+    case CONS_ERASE:
+    case CONS_DEL:
+        if( c->len > 0 ) {
+            --c->len;
+            __cio_puts( "\b \b" );
+        }
+        break;
+
+    case CONS_KILL:
+        while( c->len > 0 ) {
+            --c->len;
+            __cio_puts( "\b \b" );
+        }
+        break;
+
+    case EOT:
+        _cons_end_line( c, EOT );
+        break;
+
+    case '\n':
+        __cio_putchar( '\n' );
+        _cons_end_line( c, '\n' );
+        break;
+
+    default:
+        // leave room for the newline
+        if( c->len < CONS_LINE - 1 ) {
+            c->line[ c->len++ ] = ch;
+            __cio_putchar( ch );
+        } else {
+            ++c->dropped;
+        }
+    }
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _cons_init() - initialize the console input module
+//
+void _cons_init( void ) {
+    Console *c = &_cons;
+
+    c->mode = CONS_MODE_LINE;
+    __ring_init( &c->in, c->inbuf, CONS_BUF_SIZE );
+    c->lines = c->len = 0;
+    c->deferred = false;
+    c->dropped = 0;
+
+    c->reading = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    assert( c->reading );
+
+    __cio_puts( " CONS" );
+}
+
+//
+// _cons_notify() - take new keystrokes from the console
+//
+// Called by the keyboard ISR (as the cio notification function, or
+// from the one the kernel installs) with interrupts disabled.
+//
+// @param ch   The character just typed (unused; every character
+//             waiting in the console input queue is taken)
+//
+void _cons_notify( int ch ) {
+    Console *c = &_cons;
+
+    while( (ch = __cio_takechar()) >= 0 ) {
+        _cons_key( c, ch );
+    }
+
+    if( _cons_wake(c) ) {
+        _kthread_preempt();
+    }
+}
+
+//
+// _cons_read() - read() for the console, on behalf of the current process
+//
+// @param buf     Where to put the input
+// @param length  The size of 'buf'
+//
+// @returns The number of characters read, or -1 if the current process
+//          has been blocked (the caller must dispatch another process)
+//
+int _cons_read( char *buf, uint32 length ) {
+    Console *c = &_cons;
+    uint32 flags;
+    int n = -1;
+
+    if( length < 1 ) {
+        return( 0 );
+    }
+
+    flags = __get_flags();
+    __cli();
+
+    // earlier readers get the input first
+    if( _queue_length(c->reading) == 0 && _cons_ready(c) ) {
+        n = _cons_take( c, buf, length );
+    } else {
+        _current->state = BLOCKED;
+        _current->queue = c->reading;
+        _queue_enque( c->reading, (void *) _current );
+    }
+
+    __set_flags( flags );
+
+    return( n );
+}
+
+//
+// _cons_ioctl() - examine or change a console setting (IOC_CONS_*)
+//
+// @returns The previous setting, or an error code
+//
+int32 _cons_ioctl( uint32 cmd, uint32 arg ) {
+    Console *c = &_cons;
+    bool set = (cmd & IOC_GET) == 0;
+    uint32 flags;
+    int32 old;
+
+    switch( cmd & ~IOC_GET ) {
+
+    case IOC_CONS_MODE:
+        old = c->mode;
+        if( set ) {
+            if( arg > CONS_MODE_LINE ) {
+                return( E_PARAM );
+            }
+            flags = __get_flags();
+            __cli();
+            if( arg == CONS_MODE_RAW && c->mode == CONS_MODE_LINE ) {
+                // what has been typed so far can be read now
+                (void) __ring_write( &c->in, c->line, c->len );
+                c->len = c->lines = 0;
+            } else if( arg == CONS_MODE_LINE && c->mode == CONS_MODE_RAW ) {
+                // raw input may already hold complete lines
+                c->lines = _cons_count_lines( c );
+            }
+            c->mode = arg;
+            // either change can give blocked readers something to read
+            (void) _cons_wake( c );
+            __set_flags( flags );
+        }
+        break;
+
+    default:
+        return( E_PARAM );
+    }
+
+    return( old );
+}
+
+//
+// _cons_focus() - choose what the display shows
+//
+// @param pcb  The process whose screen is to be shown (it must have
+//             one), or NULL for the console output
+//
+void _cons_focus( Pcb *pcb ) {
+    uint32 flags = __get_flags();
+
+    __cli();
+    if( pcb != _cons_owner ) {
+        _cons_owner = pcb;
+        __cio_show( pcb != NULL ? pcb->screen : NULL );
+    }
+    __set_flags( flags );
+}
+
+//
+// _cons_map() - get a process' screen, and show it or stop showing it
+//
+// The screen is allocated (blank) on the first call for the process.
+//
+// @param pcb   The process
+// @param show  Give the process the focus (true) or take it away
+//
+// @returns The screen, or NULL if it could not be allocated
+//
+uint16 *_cons_map( Pcb *pcb, bool show ) {
+
+    if( pcb->screen == NULL ) {
+        uint16 *screen = (uint16 *) _kalloc_page( 1 );
+        if( screen == NULL ) {
+            return( NULL );
+        }
+        for( int i = 0; i < CONS_COLS * CONS_ROWS; ++i ) {
+            screen[ i ] = CONS_BLANK;
+        }
+        pcb->screen = screen;
+    }
+
+    if( show ) {
+        _cons_focus( pcb );
+    } else if( _cons_owner == pcb ) {
+        _cons_focus( NULL );
+    }
+
+    return( pcb->screen );
+}
+
+//
+// _cons_unmap() - release the screen of a terminating process
+//
+// The console output is shown again if the process had the focus.
+//
+void _cons_unmap( Pcb *pcb ) {
+
+    if( pcb->screen == NULL ) {
+        return;
+    }
+
+    if( _cons_owner == pcb ) {
+        _cons_focus( NULL );
+    }
+    _kfree_page( pcb->screen );
+    pcb->screen = NULL;
+}
+
+//
+// _cons_blocked() - number of processes waiting for console input
+//
+uint32 _cons_blocked( void ) {
+
+    return( _queue_length(_cons.reading) );
+}
+
+//
+// _cons_queue_dump() - dump the queue of processes waiting for input
+//
+void _cons_queue_dump( void ) {
+
+    _queue_dump( "Console reading queue", _cons.reading );
+}
@@ -0,0 +1,128 @@
+/*
+** SCCS ID:	@(#)cons.h	1.1	3/30/20
+**
+** File:	cons.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Console input declarations
+**
+** Keystrokes collected by the keyboard ISR in cio.c are handed to this
+** module, which buffers them for processes reading CHAN_CONS.  A read
+** blocks until there is input for it, and the reader is awakened (by
+** deferred work) when the input arrives.
+**
+** In line mode (the default), a line is edited before it can be read:
+** keystrokes are echoed, backspace erases the last character, ^U
+** erases the whole line, and the line is completed by Enter (which is
+** kept) or ^D (which is not; ^D on an empty line reads as end-of-file).
+** Each read returns at most one line.  In raw mode, keystrokes are not
+** echoed, and can be read as soon as they are typed.
+**
+** This module also decides what the display shows: the console output,
+** or the screen (from conmap()) of the process which has the focus.
+*/
+
+#ifndef _CONS_H_
+#define _CONS_H_
+
+#include "common.h"
+
+#include "process.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+// size of the buffer of completed input (a power of two), and the
+// longest line which can be edited
+
+#define	CONS_BUF_SIZE	512
+#define	CONS_LINE	128
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Prototypes
+*/
+
+//
+// _cons_init() - initialize the console input module
+//
+void _cons_init( void );
+
+//
+// _cons_notify() - take new keystrokes from the console
+//
+// Called by the keyboard ISR (as the cio notification function, or
+// from the one the kernel installs) with interrupts disabled.
+//
+// @param ch   The character just typed (unused; every character
+//             waiting in the console input queue is taken)
+//
+void _cons_notify( int ch );
+
+//
+// _cons_read() - read() for the console, on behalf of the current process
+//
+// @param buf     Where to put the input
+// @param length  The size of 'buf'
+//
+// @returns The number of characters read, or -1 if the current process
+//          has been blocked (the caller must dispatch another process)
+//
+int _cons_read( char *buf, uint32 length );
+
+//
+// _cons_ioctl() - examine or change a console setting (IOC_CONS_*)
+//
+// @returns The previous setting, or an error code
+//
+int32 _cons_ioctl( uint32 cmd, uint32 arg );
+
+//
+// _cons_focus() - choose what the display shows
+//
+// @param pcb  The process whose screen is to be shown (it must have
+//             one), or NULL for the console output
+//
+void _cons_focus( Pcb *pcb );
+
+//
+// _cons_map() - get a process' screen, and show it or stop showing it
+//
+// The screen is allocated (blank) on the first call for the process.
+//
+// @param pcb   The process
+// @param show  Give the process the focus (true) or take it away
+//
+// @returns The screen, or NULL if it could not be allocated
+//
+uint16 *_cons_map( Pcb *pcb, bool show );
+
+//
+// _cons_unmap() - release the screen of a terminating process
+//
+// The console output is shown again if the process had the focus.
+//
+void _cons_unmap( Pcb *pcb );
+
+//
+// _cons_blocked() - number of processes waiting for console input
+//
+uint32 _cons_blocked( void );
+
+//
+// _cons_queue_dump() - dump the queue of processes waiting for input
+//
+void _cons_queue_dump( void );
+
+#endif
+
+#endif
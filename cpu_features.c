@@ -0,0 +1,198 @@
+/*
+** SCCS ID:	@(#)cpu_features.c	1.1	3/30/20
+**
+** File:	cpu_features.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	CPU feature detection implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "cpu_features.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// maximum number of selections remembered for _cpu_dump()
+
+#define	CPU_MAX_CHOICES	16
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// a selection made by _cpu_select()
+
+typedef struct choice_s {
+    const char *what;
+    const char *name;
+} Choice;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+static Choice _choices[ CPU_MAX_CHOICES ];
+static uint32 _nchoices;
+
+// names of some of the more interesting features, for _cpu_dump()
+
+static const struct {
+    uint32 feature;
+    const char *name;
+} _names[] = {
+    { CPU_FPU, "fpu" },     { CPU_PSE, "pse" },     { CPU_TSC, "tsc" },
+    { CPU_MSR, "msr" },     { CPU_APIC, "apic" },   { CPU_SEP, "sep" },
+    { CPU_PGE, "pge" },     { CPU_CMOV, "cmov" },   { CPU_MMX, "mmx" },
+    { CPU_FXSR, "fxsr" },   { CPU_SSE, "sse" },     { CPU_SSE2, "sse2" },
+    { CPU_SSE3, "sse3" },   { CPU_SSSE3, "ssse3" }, { CPU_SSE41, "sse4.1" },
+    { CPU_SSE42, "sse4.2" }, { CPU_POPCNT, "popcnt" }, { CPU_AVX, "avx" },
+    { CPU_AVX2, "avx2" },   { CPU_ERMS, "erms" },   { CPU_MWAIT, "mwait" },
+    { CPU_X2APIC, "x2apic" }, { CPU_RDRAND, "rdrand" },
+    { CPU_RDTSCP, "rdtscp" }, { CPU_INVTSC, "invtsc" }, { CPU_NX, "nx" },
+    { CPU_LM, "lm" },       { CPU_HYPERVISOR, "hypervisor" }
+};
+
+#define	N_NAMES		(sizeof(_names) / sizeof(_names[0]))
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+CpuInfo _cpu_info;
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _cpu_init() - decode the CPUID leaves
+//
+void _cpu_init( void ) {
+    uint32 regs[4];
+
+    __memclr( &_cpu_info, sizeof(_cpu_info) );
+    _nchoices = 0;
+
+    // leaf 0: highest leaf, and the vendor string in EBX, EDX, ECX
+    __cpuid( 0, regs );
+    _cpu_info.max_leaf = regs[0];
+    *(uint32 *) &_cpu_info.vendor[0] = regs[1];
+    *(uint32 *) &_cpu_info.vendor[4] = regs[3];
+    *(uint32 *) &_cpu_info.vendor[8] = regs[2];
+
+    if( _cpu_info.max_leaf >= 1 ) {
+        __cpuid( 1, regs );
+        uint32 family = (regs[0] >> 8) & 0xf;
+        uint32 model = (regs[0] >> 4) & 0xf;
+        if( family == 0xf ) {
+            family += (regs[0] >> 20) & 0xff;
+        }
+        if( family >= 0x6 ) {
+            model += ((regs[0] >> 16) & 0xf) << 4;
+        }
+        _cpu_info.family = family;
+        _cpu_info.model = model;
+        _cpu_info.stepping = regs[0] & 0xf;
+        _cpu_info.words[ CPU_WORD_1_EDX ] = regs[3];
+        _cpu_info.words[ CPU_WORD_1_ECX ] = regs[2];
+
+        // family 6 CPUs before model 3 report SEP but don't support it
+        if( family == 6 && model < 3 ) {
+            _cpu_info.words[ CPU_WORD_1_EDX ] &= ~(1 << (CPU_SEP & 31));
+        }
+    }
+
+    if( _cpu_info.max_leaf >= 7 ) {
+        __cpuid( 7, regs );
+        _cpu_info.words[ CPU_WORD_7_EBX ] = regs[1];
+        _cpu_info.words[ CPU_WORD_7_ECX ] = regs[2];
+    }
+
+    // the extended leaves may not exist at all
+    __cpuid( 0x80000000, regs );
+    if( (regs[0] & 0xffff0000) == 0x80000000 ) {
+        _cpu_info.max_ext_leaf = regs[0];
+    }
+
+    if( _cpu_info.max_ext_leaf >= 0x80000001 ) {
+        __cpuid( 0x80000001, regs );
+        _cpu_info.words[ CPU_WORD_X1_EDX ] = regs[3];
+        _cpu_info.words[ CPU_WORD_X1_ECX ] = regs[2];
+    }
+
+    if( _cpu_info.max_ext_leaf >= 0x80000007 ) {
+        __cpuid( 0x80000007, regs );
+        _cpu_info.words[ CPU_WORD_X7_EDX ] = regs[3];
+    }
+
+    __cio_puts( " CPU" );
+}
+
+//
+// _cpu_has() - does this CPU support a feature?
+//
+bool _cpu_has( uint32 feature ) {
+
+    if( feature == CPU_ANY ) {
+        return( true );
+    }
+
+    if( (feature >> 5) >= CPU_NWORDS ) {
+        return( false );
+    }
+
+    return( CPU_HAS(&_cpu_info,feature) );
+}
+
+//
+// _cpu_select() - choose an implementation of a routine
+//
+void *_cpu_select( const char *what, const CpuImpl *impls ) {
+
+    while( !_cpu_has(impls->feature) ) {
+        ++impls;
+    }
+
+    if( _nchoices < CPU_MAX_CHOICES ) {
+        _choices[_nchoices].what = what;
+        _choices[_nchoices].name = impls->name;
+        ++_nchoices;
+    }
+
+    return( impls->fcn );
+}
+
+//
+// _cpu_dump() - print the CPU features and the selected implementations
+//
+void _cpu_dump( void ) {
+
+    __cio_printf( "\nCPU: %s family %d model %d stepping %d (leaves %x, %x)\n",
+                  _cpu_info.vendor, _cpu_info.family, _cpu_info.model,
+                  _cpu_info.stepping, _cpu_info.max_leaf,
+                  _cpu_info.max_ext_leaf );
+
+    __cio_puts( "features:" );
+    for( uint32 i = 0; i < N_NAMES; ++i ) {
+        if( _cpu_has(_names[i].feature) ) {
+            __cio_printf( " %s", _names[i].name );
+        }
+    }
+    __cio_putchar( '\n' );
+
+    for( uint32 i = 0; i < _nchoices; ++i ) {
+        __cio_printf( "  %s: %s\n", _choices[i].what, _choices[i].name );
+    }
+}
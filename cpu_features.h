@@ -0,0 +1,95 @@
+/*
+** SCCS ID:	@(#)cpu_features.h	1.1	3/30/20
+**
+** File:	cpu_features.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	CPU feature detection declarations
+**
+** The CPUID leaves are decoded once, at boot, into a table of feature
+** bits (see CpuInfo in types.h).  Code with several implementations of
+** a hot routine lists them in a CpuImpl array, best first, and calls
+** _cpu_select() from its initialization routine to pick the first one
+** whose required feature is present; the result is kept in a function
+** pointer, so there is no feature test on each call.
+*/
+
+#ifndef _CPU_FEATURES_H_
+#define _CPU_FEATURES_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+// "feature" for an implementation which works on any CPU
+
+#define	CPU_ANY		0xffffffff
+
+/*
+** Types
+*/
+
+// one implementation of a routine, and the feature it requires
+
+typedef struct cpuimpl_s {
+    uint32 feature;         // CPU_* feature, or CPU_ANY
+    void *fcn;              // the implementation
+    const char *name;       // for reports
+} CpuImpl;
+
+/*
+** Globals
+*/
+
+// the decoded CPUID information
+extern CpuInfo _cpu_info;
+
+/*
+** Prototypes
+*/
+
+//
+// _cpu_init() - decode the CPUID leaves
+//
+// Must be called before any other module is initialized.
+//
+void _cpu_init( void );
+
+//
+// _cpu_has() - does this CPU support a feature?
+//
+// @param feature  A CPU_* feature number (see types.h)
+//
+// @returns true if the feature is present and usable
+//
+bool _cpu_has( uint32 feature );
+
+//
+// _cpu_select() - choose an implementation of a routine
+//
+// @param what   Name of the routine (for reports)
+// @param impls  Implementations, best first; the last must be CPU_ANY
+//
+// @returns The chosen implementation
+//
+void *_cpu_select( const char *what, const CpuImpl *impls );
+
+//
+// _cpu_dump() - print the CPU features and the selected implementations
+//
+void _cpu_dump( void );
+
+#endif
+
+#endif
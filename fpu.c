@@ -0,0 +1,253 @@
+/*
+** SCCS ID:	@(#)fpu.c	1.1	3/30/20
+**
+** File:	fpu.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	FPU/SSE state management implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include <x86arch.h>
+
+#include "common.h"
+
+#include "fpu.h"
+#include "cpu_features.h"
+#include "kmem.h"
+#include "scheduler.h"
+#include "syscalls.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// number of save areas carved from each page added to the cache
+
+#define AREAS_PER_PAGE      (PAGE_SIZE / sizeof(FpuArea))
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+// is lazy switching in use?
+static bool _fpu_enabled;
+
+// the process whose state is in the FPU registers, or NULL
+static Pcb *_fpu_owner;
+
+// our copy of CR0.TS
+static bool _fpu_ts;
+
+// cache of unused save areas, linked through their first word
+static FpuArea *_free_areas;
+
+// the state given to a process when it first uses the FPU
+static FpuArea _fpu_initial;
+
+// statistics
+static uint32 _fpu_traps;       // #NM traps taken
+static uint32 _fpu_switches;    // FPU state switched between processes
+static uint32 _fpu_areas;       // save areas in use
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _fpu_alloc() - allocate a save area
+//
+// @returns The area, or NULL
+//
+static FpuArea *_fpu_alloc( void ) {
+
+    if( _free_areas == NULL ) {
+        FpuArea *block = (FpuArea *) _kalloc_page( 1 );
+        if( block == NULL ) {
+            return( NULL );
+        }
+        for( uint32 i = 0; i < AREAS_PER_PAGE; ++i ) {
+            *(FpuArea **) &block[i] = _free_areas;
+            _free_areas = &block[i];
+        }
+    }
+
+    FpuArea *area = _free_areas;
+    _free_areas = *(FpuArea **) area;
+    ++_fpu_areas;
+
+    return( area );
+}
+
+//
+// _fpu_terminate() - terminate the current process
+//
+// Used when the current process can't be allowed to continue using
+// the FPU.
+//
+// @param status  Its exit status
+//
+static void _fpu_terminate( int32 status ) {
+    Pcb *parent = _pcb_find( _current->ppid );
+
+    // kernel threads must not use the FPU at all
+    assert( parent );
+
+    _current->exit_status = status;
+    _really_exit( _current, parent, status );
+    _dispatch();
+}
+
+//
+// _fpu_trap() - ISR for #NM (device not available)
+//
+// The current process has used the FPU while CR0.TS was set.  Save the
+// owner's state, and give the FPU to the current process.
+//
+static void _fpu_trap( int vector, int code ) {
+
+    ++_fpu_traps;
+
+    // make sure the current process has somewhere to keep its state
+    // before we disturb anyone else's
+    if( _current->fpu == NULL ) {
+        _current->fpu = _fpu_alloc();
+        if( _current->fpu == NULL ) {
+            __sprint( b256, "PID %d: no FPU save area", _current->pid );
+            WARNING( b256 );
+            _fpu_terminate( E_NO_MEMORY );
+            return;
+        }
+        __memcpy( _current->fpu, &_fpu_initial, sizeof(FpuArea) );
+    }
+
+    __clts();
+    _fpu_ts = false;
+
+    if( _fpu_owner != _current ) {
+        if( _fpu_owner != NULL ) {
+            __fxsave( _fpu_owner->fpu );
+        }
+        __fxrstor( _current->fpu );
+        _fpu_owner = _current;
+        ++_fpu_switches;
+    }
+}
+
+//
+// _fpu_fault() - ISR for unmasked x87 (#MF) and SIMD (#XM) exceptions
+//
+// These can only be raised by a process which unmasked them; the
+// process is terminated.
+//
+static void _fpu_fault( int vector, int code ) {
+
+    __sprint( b256, "PID %d: FPU exception 0x%02x", _current->pid, vector );
+    WARNING( b256 );
+
+    // the FPU state is of no further use to anyone
+    __clts();
+    __fninit();
+    _fpu_owner = NULL;
+
+    _fpu_terminate( E_INVALID );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _fpu_init() - initialize the FPU module
+//
+void _fpu_init( void ) {
+
+    _fpu_owner = NULL;
+    _free_areas = NULL;
+    _fpu_traps = _fpu_switches = _fpu_areas = 0;
+
+    _fpu_enabled = _cpu_has( CPU_FPU ) && _cpu_has( CPU_FXSR ) &&
+                   _cpu_has( CPU_SSE );
+
+    if( !_fpu_enabled ) {
+        // any FPU instruction will raise #UD
+        __set_cr0( (__get_cr0() | CR0_EM) & ~CR0_TS );
+        __cio_puts( " FPU(off)" );
+        return;
+    }
+
+    // native FPU error reporting, WAIT honors TS, no emulation
+    __set_cr0( (__get_cr0() | CR0_NE | CR0_MP) & ~(CR0_EM | CR0_TS) );
+    __set_cr4( __get_cr4() | CR4_OSFXSR | CR4_OSXMMEXCPT );
+
+    // capture a clean state (all exceptions masked) for new users
+    __fninit();
+    __fxsave( &_fpu_initial );
+
+    __install_isr( INT_VEC_DEVICE_NOT_AVAILABLE, _fpu_trap );
+    __install_isr( INT_VEC_COPROCESSOR_ERROR, _fpu_fault );
+    __install_isr( INT_VEC_SIMD_FP_EXCEPTION, _fpu_fault );
+
+    // nobody owns it yet
+    __set_cr0( __get_cr0() | CR0_TS );
+    _fpu_ts = true;
+
+    __cio_puts( " FPU" );
+}
+
+//
+// _fpu_switch() - note that a process has been dispatched
+//
+void _fpu_switch( Pcb *pcb ) {
+
+    if( !_fpu_enabled ) {
+        return;
+    }
+
+    // only touch CR0 when TS actually has to change
+    bool ts = pcb != _fpu_owner;
+    if( ts != _fpu_ts ) {
+        if( ts ) {
+            __set_cr0( __get_cr0() | CR0_TS );
+        } else {
+            __clts();
+        }
+        _fpu_ts = ts;
+    }
+}
+
+//
+// _fpu_release() - give up a process' FPU state
+//
+void _fpu_release( Pcb *pcb ) {
+
+    if( _fpu_owner == pcb ) {
+        _fpu_owner = NULL;
+    }
+
+    if( pcb->fpu != NULL ) {
+        *(FpuArea **) pcb->fpu = _free_areas;
+        _free_areas = pcb->fpu;
+        pcb->fpu = NULL;
+        --_fpu_areas;
+    }
+}
+
+//
+// _fpu_dump() - print FPU statistics
+//
+void _fpu_dump( void ) {
+
+    __cio_printf( "FPU: %s, owner PID %d, traps %d switches %d areas %d\n",
+                  _fpu_enabled ? "lazy" : "disabled",
+                  _fpu_owner ? _fpu_owner->pid : 0,
+                  _fpu_traps, _fpu_switches, _fpu_areas );
+}
@@ -0,0 +1,97 @@
+/*
+** SCCS ID:	@(#)fpu.h	1.1	3/30/20
+**
+** File:	fpu.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	FPU/SSE state management declarations
+**
+** The FPU, MMX and SSE registers are not part of the saved Context.
+** Instead, they are switched lazily: whenever a process other than the
+** one whose state is in the FPU is dispatched, CR0.TS is set, and the
+** first FPU or SSE instruction it executes raises #NM.  The #NM handler
+** saves the registers into the owner's save area, loads the current
+** process' state (or a clean initial state), and clears CR0.TS.  A
+** process which never uses the FPU never takes the trap, and never has
+** a save area allocated for it.
+**
+** The kernel itself must not use the FPU or SSE registers.
+*/
+
+#ifndef _FPU_H_
+#define _FPU_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+#include "process.h"
+
+// size of an FXSAVE area
+
+#define	FPU_AREA_SIZE	512
+
+/*
+** Types
+*/
+
+// an FXSAVE area; must be aligned on a 16-byte boundary
+
+typedef struct fpuarea_s {
+    uint8 data[ FPU_AREA_SIZE ];
+} __attribute__((aligned(16))) FpuArea;
+
+/*
+** Globals
+*/
+
+/*
+** Prototypes
+*/
+
+//
+// _fpu_init() - initialize the FPU module
+//
+// Enables the FPU and SSE if the CPU has them, and installs the #NM
+// handler.  Without FXSR support the FPU is left disabled (CR0.EM).
+//
+void _fpu_init( void );
+
+//
+// _fpu_switch() - note that a process has been dispatched
+//
+// Called by _dispatch() with the new current process.  Sets CR0.TS
+// unless that process already owns the FPU.
+//
+// @param pcb   The process being dispatched
+//
+void _fpu_switch( Pcb *pcb );
+
+//
+// _fpu_release() - give up a process' FPU state
+//
+// Called when a PCB is freed.  Returns its save area to the cache.
+//
+// @param pcb   The process
+//
+void _fpu_release( Pcb *pcb );
+
+//
+// _fpu_dump() - print FPU statistics
+//
+void _fpu_dump( void );
+
+#endif
+
+#endif
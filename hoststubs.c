@@ -0,0 +1,322 @@
+/*
+** SCCS ID:	@(#)hoststubs.c	1.1	3/30/20
+**
+** File:	hoststubs.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Linux host environment for the hosted test program
+**
+** Everything here stands in for something the OS (or the C library)
+** would normally provide; see hosttest.h.
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "hosttest.h"
+#include "cons.h"
+#include "cpu_features.h"
+#include "fpu.h"
+#include "kernel.h"
+#include "kthread.h"
+#include "process.h"
+#include "queues.h"
+#include "scheduler.h"
+#include "sio.h"
+#include "syscalls.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// Linux (i386) system calls used here
+
+#define	LINUX_WRITE		4
+#define	LINUX_EXIT_GROUP	252
+#define	LINUX_CLOCK_GETTIME	265
+
+#define	LINUX_STDOUT		1
+#define	LINUX_CLOCK_MONOTONIC	1
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// a Linux (i386) struct timespec
+
+typedef struct linuxtime_s {
+    int32 sec;
+    int32 nsec;
+} LinuxTime;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+// where _kalloc_slice() gets its memory
+
+static uint8 _slices[ HOST_SLICES ][ SLICE_SIZE ];
+static uint32 _slices_used;
+
+// and where _kalloc_page() gets its memory
+
+static uint8 _pages[ HOST_PAGES ][ PAGE_SIZE ];
+static uint32 _pages_used;
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+uint32 _host_fpu_switches;
+uint32 _host_ring_polls;
+uint32 _host_warnings;
+
+// the OS globals the modules refer to
+
+char b256[ 256 ];
+char b512[ 512 ];
+
+Pcb *_current;
+Pcb *_idle_pcb;
+
+uint32 _active;
+Pid _next_pid;
+
+Queue _waiting;
+Queue _zombie;
+Queue _sleeping;
+Queue _ready;
+Queue _kready;
+
+uint32 _isr_depth;
+bool _in_syscall;
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _linux() - make a Linux system call
+//
+static int32 _linux( uint32 code, uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    int32 ret;
+
+    __asm__ __volatile__( "int $0x80"
+        : "=a" (ret)
+        : "a" (code), "b" (arg1), "c" (arg2), "d" (arg3)
+        : "memory" );
+
+    return( ret );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _host_start() - the program's entry point
+//
+void _host_start( void ) {
+
+    (void) _linux( LINUX_EXIT_GROUP, _host_main(), 0, 0 );
+}
+
+//
+// _host_write() - write to the standard output
+//
+void _host_write( const char *buf, uint32 length ) {
+
+    while( length > 0 ) {
+        int32 n = _linux( LINUX_WRITE, LINUX_STDOUT, (uint32) buf, length );
+        if( n <= 0 ) {
+            return;
+        }
+        buf += n;
+        length -= n;
+    }
+}
+
+//
+// _host_ns() - read the host's monotonic clock
+//
+// @returns The time, in nanoseconds
+//
+uint64 _host_ns( void ) {
+    LinuxTime t;
+
+    (void) _linux( LINUX_CLOCK_GETTIME, LINUX_CLOCK_MONOTONIC,
+                   (uint32) &t, 0 );
+
+    return( (uint64) t.sec * 1000000000 + (uint32) t.nsec );
+}
+
+/*
+** Console output (cio.c)
+*/
+
+void __cio_putchar( unsigned int c ) {
+    char ch = c;
+
+    _host_write( &ch, 1 );
+}
+
+void __cio_puts( char *str ) {
+
+    _host_write( str, __strlen(str) );
+}
+
+void __cio_printf( char *fmt, ... ) {
+    char buf[ 512 ];
+    uint32 n;
+
+    n = __vsnprint( buf, sizeof(buf), fmt, (int32 *)(&fmt) + 1 );
+    _host_write( buf, n );
+}
+
+void __cio_show( unsigned short *screen ) {
+}
+
+/*
+** Support routines (support.c, kmem.c, klog.c)
+*/
+
+//
+// __panic() - report a panic (usually, a failed assertion) and give up
+//
+void __panic( char *reason ) {
+
+    __cio_printf( "\nPANIC: %s\n", reason );
+    (void) _linux( LINUX_EXIT_GROUP, HOST_PANICKED, 0, 0 );
+}
+
+//
+// _kalloc_slice() - allocate a slice from a fixed pool
+//
+void *_kalloc_slice( void ) {
+
+    if( _slices_used >= HOST_SLICES ) {
+        return( NULL );
+    }
+
+    return( _slices[ _slices_used++ ] );
+}
+
+//
+// _klog() - kernel messages are written out immediately
+//
+void _klog( uint32 level, char *fmt, ... ) {
+    char buf[ KLOG_LINE ];
+    uint32 n;
+
+    ++_host_warnings;
+    n = __vsnprint( buf, sizeof(buf) - 1, fmt, (int32 *)(&fmt) + 1 );
+    buf[ n++ ] = '\n';
+    _host_write( buf, n );
+}
+
+void _klog_flush( void ) {
+}
+
+//
+// _kalloc_page() - allocate pages from a fixed pool
+//
+void *_kalloc_page( uint32 count ) {
+
+    if( count > HOST_PAGES - _pages_used ) {
+        return( NULL );
+    }
+
+    _pages_used += count;
+    return( _pages[ _pages_used - count ] );
+}
+
+/*
+** The rest of the OS
+*/
+
+void _stk_free( Stack *stk ) {
+}
+
+void _fpu_release( Pcb *pcb ) {
+}
+
+void _fpu_switch( Pcb *pcb ) {
+
+    ++_host_fpu_switches;
+}
+
+void _sys_ring_poll( void ) {
+
+    ++_host_ring_polls;
+}
+
+uint32 _cons_blocked( void ) {
+
+    return( 0 );
+}
+
+void _sio_blocked( uint32 *readers, uint32 *writers ) {
+
+    *readers = *writers = 0;
+}
+
+void *_cpu_select( const char *what, const CpuImpl *impls ) {
+
+    // the last one must work everywhere
+    while( impls->feature != CPU_ANY ) {
+        ++impls;
+    }
+    return( impls->fcn );
+}
+
+/*
+** User library support (ulibs.S)
+*/
+
+void exit_helper( void ) {
+}
+
+int32 write( int chan, const void *buf, uint32 length ) {
+
+    _host_write( buf, length );
+    return( length );
+}
+
+int32 cpuinfo( CpuInfo *info ) {
+
+    return( E_NOT_FOUND );
+}
+
+const TimePage *timepage( void ) {
+
+    return( NULL );
+}
+
+uint64 rdtsc( void ) {
+
+    return( __rdtsc() );
+}
+
+void __memcopy_rep( void *dst, const void *src, uint32 len ) {
+
+    __memcpy_movsl( dst, src, len );
+}
+
+void __memcopy_sse2( void *dst, const void *src, uint32 len ) {
+
+    __memcpy_movsl( dst, src, len );
+}
+
+void __memfill_rep( void *buf, uint32 len, uint32 value ) {
+
+    __memset_stosl( buf, len, value );
+}
+
+void __memfill_sse2( void *buf, uint32 len, uint32 value ) {
+
+    __memset_stosl( buf, len, value );
+}
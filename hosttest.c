@@ -0,0 +1,1166 @@
+/*
+** SCCS ID:	@(#)hosttest.c	1.1	3/30/20
+**
+** File:	hosttest.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Unit tests and microbenchmarks for the hosted test program
+**
+** The tests check the queue module (both FIFO and ordered queues),
+** ring buffers, __sprint() and __vsnprint() in the kernel library,
+** sprint() in the user library, process creation, and the scheduler.
+** Each failed check is reported with its line number, and the program
+** exits with HOST_FAILED if there were any.
+**
+** The benchmarks then time the queue operations, __sprint(), the
+** schedule/dispatch cycle, ring buffer transfers (byte-at-a-time and
+** bulk), and the memory and string routines (against the original
+** byte-at-a-time loops, for sizes from 1 byte to 64KB).  Every
+** measurement is repeated BENCH_REPS times and the fastest run is
+** reported, and all inputs are generated from fixed seeds, so the
+** numbers from one run can be compared with those from another on the
+** same machine.
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "hosttest.h"
+#include "kthread.h"
+#include "process.h"
+#include "queues.h"
+#include "ring.h"
+#include "scheduler.h"
+#include "ulib.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// record the result of a check
+
+#define	CHECK(x)		_check( (x), # x, __LINE__ )
+#define	CHECK_STR(got,want)	_check_str( (got), (want), __LINE__ )
+
+// entries used in the queue tests, and the number of random operations
+// in each of the mixed queue tests
+
+#define	N_ITEMS		200
+#define	N_MIXED		64
+#define	MIXED_OPS	5000
+
+// processes used in the scheduler tests and benchmark
+
+#define	N_TEST_PROCS	4
+
+// each measurement is repeated, and the fastest run is reported
+
+#define	BENCH_REPS	5
+#define	BENCH_NONE	0xffffffff
+
+// operations timed in each run of the FIFO, __sprint() and scheduler
+// benchmarks, and the largest ordered queue timed
+
+#define	BENCH_OPS	100000
+#define	BENCH_ORDER_MAX	10000
+
+// largest block timed by the memory and string benchmarks, and the
+// approximate number of bytes processed in each of their runs
+
+#define	BENCH_MEM_MAX	(64 * 1024)
+#define	BENCH_MEM_BYTES	(256 * 1024)
+
+// size of the ring buffer used in the ring tests and benchmark, and
+// the largest chunk the benchmark moves through it
+
+#define	BENCH_RING_SIZE	4096
+#define	BENCH_RING_MAX	1024
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// an entry in a test queue
+
+typedef struct item_s {
+    QLink link;
+    uint32 key;
+    uint32 seq;         // order in which it was added
+    bool queued;        // is it on the queue?
+} Item;
+
+// a __sprint() test case; every format is given the same three
+// arguments, and uses a prefix of them
+
+typedef struct fmtcase_s {
+    char *fmt;
+    int32 a, b, c;
+    char *want;
+} FmtCase;
+
+// the best time seen for a measurement
+
+typedef struct best_s {
+    uint32 ns;
+    uint32 cycles;
+} Best;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+static uint32 _checks;
+static uint32 _failures;
+
+static Item _items[ BENCH_ORDER_MAX ];
+
+static Pcb _procs[ N_TEST_PROCS ];
+static Pcb _idle;
+
+static Stack _stacks[ 3 ];
+
+static uint8 _src[ BENCH_MEM_MAX ];
+static uint8 _dst[ BENCH_MEM_MAX ];
+
+static uint8 _ring_data[ BENCH_RING_SIZE ];
+
+static const FmtCase _fmt_cases[] = {
+    { "no conversions",           0, 0, 0,  "no conversions" },
+    { "%c",                     'x', 0, 0,  "x" },
+    { "[%3c|%-3c]",             'a', 'b', 0,  "[  a|b  ]" },
+    { "%s",       (int32) "hello", 0, 0,  "hello" },
+    { "[%6s|%-6s]", (int32) "ab", (int32) "cd", 0,  "[    ab|cd    ]" },
+    { "%s%s", (int32) "", (int32) "x", 0,  "x" },
+    { "%d",                       0, 0, 0,  "0" },
+    { "%d",                 1234567, 0, 0,  "1234567" },
+    { "%d",                     -42, 0, 0,  "-42" },
+    { "%d %d",   0x7fffffff, 0x80000000, 0,  "2147483647 -2147483648" },
+    { "[%5d|%-5d|%05d]",     42, -7, 42,  "[   42|-7   |00042]" },
+    { "%x",                       0, 0, 0,  "0" },
+    { "%x",              0xdeadbeef, 0, 0,  "DEADBEEF" },
+    { "%x %x",         0x80000000, 0x1f, 0,  "80000000 1F" },
+    { "[%08x|%-4x]",         0x1f, 0xa, 0,  "[0000001F|A   ]" },
+    { "%o",                       0, 0, 0,  "0" },
+    { "%o %o",                8, 0xffffffff, 0,  "10 37777777777" },
+    { "%s: PID %d at %08x", (int32) "kernel", 17, 0xbeef,
+                                    "kernel: PID 17 at 0000BEEF" }
+};
+
+#define	N_FMT_CASES	( sizeof(_fmt_cases) / sizeof(_fmt_cases[0]) )
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _check() - record the result of a check, reporting a failure
+//
+static void _check( bool ok, char *what, int line ) {
+
+    ++_checks;
+    if( !ok ) {
+        ++_failures;
+        __cio_printf( "hosttest.c:%d: check failed: %s\n", line, what );
+    }
+}
+
+//
+// _check_str() - check that a string is what was expected
+//
+static void _check_str( char *got, char *want, int line ) {
+
+    ++_checks;
+    if( __strcmp(got,want) != 0 ) {
+        ++_failures;
+        __cio_printf( "hosttest.c:%d: got \"%s\", expected \"%s\"\n",
+                      line, got, want );
+    }
+}
+
+//
+// _random() - the next number from a generator with a fixed seed
+//
+static uint32 _random( uint32 *seed ) {
+
+    *seed = *seed * 1103515245 + 12345;
+    return( *seed >> 8 );
+}
+
+//
+// _item_cmp() - comparison function for ordered test queues
+//
+static int _item_cmp( const void *a, const void *b ) {
+    uint32 k1 = ((const Item *) a)->key;
+    uint32 k2 = ((const Item *) b)->key;
+
+    return( k1 < k2 ? -1 : k1 > k2 );
+}
+
+//
+// _items_reset() - take all the items off any queue, and number them
+//
+static void _items_reset( uint32 n ) {
+
+    __memclr( _items, n * sizeof(Item) );
+    for( uint32 i = 0; i < n; ++i ) {
+        _items[i].seq = i;
+    }
+}
+
+/*
+** Queue tests
+*/
+
+//
+// _test_fifo() - a FIFO queue keeps the order entries arrived in
+//
+static void _test_fifo( void ) {
+    static const uint32 left[] = { 1, 2, 3, 4, 6, 7, 8 };
+    Queue q = _queue_alloc( NULL, QOFFSET(Item,link) );
+    uint32 i;
+
+    CHECK( q != NULL );
+    if( q == NULL ) {
+        return;
+    }
+
+    _items_reset( 10 );
+
+    CHECK( _queue_deque(q) == NULL );
+    CHECK( _queue_front(q) == NULL );
+
+    for( i = 0; i < 10; ++i ) {
+        _queue_enque( q, &_items[i] );
+    }
+    CHECK( _queue_length(q) == 10 );
+    CHECK( _queue_front(q) == &_items[0] );
+
+    // remove from the middle, the front and the end
+    CHECK( _queue_remove(q,&_items[5]) == &_items[5] );
+    CHECK( _queue_remove(q,&_items[0]) == &_items[0] );
+    CHECK( _queue_remove(q,&_items[9]) == &_items[9] );
+    CHECK( _queue_remove(q,&_items[5]) == NULL );
+    CHECK( _queue_length(q) == 7 );
+
+    // the iterator sees the rest in order
+    QIter iter = _queue_start( q );
+    for( i = 0; i < 7; ++i ) {
+        CHECK( _queue_next(&iter) == &_items[ left[i] ] );
+    }
+    CHECK( _queue_next(&iter) == NULL );
+
+    // and they leave in order
+    for( i = 0; i < 7; ++i ) {
+        CHECK( _queue_deque(q) == &_items[ left[i] ] );
+    }
+    CHECK( _queue_length(q) == 0 );
+    CHECK( _queue_deque(q) == NULL );
+
+    // a removed entry can be added again
+    _queue_enque( q, &_items[5] );
+    CHECK( _queue_front(q) == &_items[5] );
+    CHECK( _queue_deque(q) == &_items[5] );
+
+    // a NULL queue is empty
+    CHECK( _queue_front(NULL) == NULL );
+    CHECK( _queue_length(NULL) == 0 );
+
+    _queue_free( q );
+}
+
+//
+// _test_order() - an ordered queue releases its entries in order
+//
+// Keys are drawn from a small range, so there are many duplicates.
+// Every third entry is removed from wherever it is in the queue before
+// the rest are taken off the front.  With 'stable', entries with equal
+// keys must also leave in the order they arrived.
+//
+static void _test_order( Queue q, bool stable ) {
+    uint32 seed = 4321;
+    uint32 n = 0;
+    uint32 i;
+
+    _items_reset( N_ITEMS );
+    for( i = 0; i < N_ITEMS; ++i ) {
+        _items[i].key = _random( &seed ) % 50;
+        _queue_enque( q, &_items[i] );
+        _items[i].queued = true;
+    }
+    CHECK( _queue_length(q) == N_ITEMS );
+
+    // the iterator visits each entry once, the smallest first
+    QIter iter = _queue_start( q );
+    Item *first = (Item *) _queue_current( iter );
+    Item *it;
+    while( (it = (Item *) _queue_next(&iter)) != NULL ) {
+        CHECK( it->queued );
+        CHECK( first->key <= it->key );
+        it->queued = false;
+        ++n;
+    }
+    CHECK( n == N_ITEMS );
+
+    // take out every third one, from wherever it is
+    for( i = 0; i < N_ITEMS; ++i ) {
+        _items[i].queued = (i % 3) != 1;
+        if( !_items[i].queued ) {
+            CHECK( _queue_remove(q,&_items[i]) == &_items[i] );
+            CHECK( _queue_remove(q,&_items[i]) == NULL );
+        }
+    }
+    n = N_ITEMS - (N_ITEMS + 1) / 3;
+    CHECK( _queue_length(q) == n );
+
+    // the rest come out in order
+    Item *prev = NULL;
+    while( (it = (Item *) _queue_deque(q)) != NULL ) {
+        CHECK( it->queued );
+        it->queued = false;
+        if( prev != NULL ) {
+            CHECK( prev->key <= it->key );
+            if( stable && prev->key == it->key ) {
+                CHECK( prev->seq < it->seq );
+            }
+        }
+        prev = it;
+        --n;
+    }
+    CHECK( n == 0 );
+    CHECK( _queue_length(q) == 0 );
+}
+
+//
+// _test_mixed() - random additions, removals and removals from the
+//                 middle, checked against a simple model
+//
+static void _test_mixed( Queue q ) {
+    uint32 seed = 999;
+    uint32 queued = 0;
+
+    _items_reset( N_MIXED );
+
+    for( uint32 op = 0; op < MIXED_OPS; ++op ) {
+        Item *it = &_items[ _random(&seed) % N_MIXED ];
+
+        switch( _random(&seed) % 3 ) {
+
+        case 0:     // add it (if it isn't there already)
+            if( !it->queued ) {
+                it->key = _random( &seed ) % 100;
+                _queue_enque( q, it );
+                it->queued = true;
+                ++queued;
+            }
+            break;
+
+        case 1:     // remove it (if it is there)
+            if( it->queued ) {
+                CHECK( _queue_remove(q,it) == it );
+                it->queued = false;
+                --queued;
+            }
+            break;
+
+        default:    // take the first entry, which must be a smallest one
+            it = (Item *) _queue_deque( q );
+            if( queued == 0 ) {
+                CHECK( it == NULL );
+                break;
+            }
+            CHECK( it != NULL && it->queued );
+            if( it == NULL ) {
+                return;
+            }
+            for( uint32 i = 0; i < N_MIXED; ++i ) {
+                if( _items[i].queued ) {
+                    CHECK( it->key <= _items[i].key );
+                }
+            }
+            it->queued = false;
+            --queued;
+        }
+
+        CHECK( _queue_length(q) == queued );
+    }
+
+    while( _queue_deque(q) != NULL ) {
+        ;
+    }
+}
+
+//
+// _test_queues() - run the queue tests on each kind of queue
+//
+static void _test_queues( void ) {
+    Queue heap = _queue_alloc( _item_cmp, QOFFSET(Item,link) );
+    Queue sorted = _queue_alloc_sorted( _item_cmp, QOFFSET(Item,link) );
+
+    _test_fifo();
+
+    CHECK( heap != NULL && sorted != NULL );
+    if( heap == NULL || sorted == NULL ) {
+        return;
+    }
+
+    _test_order( heap, false );
+    _test_order( sorted, true );
+    _test_mixed( heap );
+    _test_mixed( sorted );
+
+    _queue_free( heap );
+    _queue_free( sorted );
+}
+
+/*
+** Formatting tests
+*/
+
+//
+// _vsn() - call __vsnprint() with our own parameters
+//
+static int _vsn( char *dst, uint32 size, char *fmt, ... ) {
+
+    return( __vsnprint( dst, size, fmt, (int32 *)(&fmt) + 1 ) );
+}
+
+//
+// _test_format() - check __sprint(), __vsnprint() and sprint()
+//
+static void _test_format( void ) {
+    char buf[ 64 ];
+
+    for( uint32 i = 0; i < N_FMT_CASES; ++i ) {
+        const FmtCase *t = &_fmt_cases[i];
+
+        __memset( buf, sizeof(buf), '?' );
+        __sprint( buf, t->fmt, t->a, t->b, t->c );
+        CHECK_STR( buf, t->want );
+
+        __memset( buf, sizeof(buf), '?' );
+        sprint( buf, t->fmt, t->a, t->b, t->c );
+        CHECK_STR( buf, t->want );
+
+        __memset( buf, sizeof(buf), '?' );
+        CHECK( _vsn(buf, sizeof(buf), t->fmt, t->a, t->b, t->c) ==
+               __strlen(t->want) );
+        CHECK_STR( buf, t->want );
+    }
+
+    // __vsnprint() stops at the end of the buffer
+    CHECK( _vsn(buf, 6, "%s world", "hello") == 5 );
+    CHECK_STR( buf, "hello" );
+    CHECK( _vsn(buf, 4, "%8d", 1) == 3 );
+    CHECK_STR( buf, "   " );
+    CHECK( _vsn(buf, 3, "%-6s|", "ab") == 2 );
+    CHECK_STR( buf, "ab" );
+    CHECK( _vsn(buf, 1, "anything") == 0 );
+    CHECK_STR( buf, "" );
+
+    // and doesn't touch it at all if it has no room
+    buf[0] = 'z';
+    CHECK( _vsn(buf, 0, "anything") == 0 );
+    CHECK( buf[0] == 'z' );
+}
+
+/*
+** Ring buffer tests
+*/
+
+//
+// _test_ring() - check single-byte and bulk ring transfers
+//
+static void _test_ring( void ) {
+    Ring ring;
+    uint8 buf[ 16 ];
+    bool ok = true;
+
+    __ring_init( &ring, _ring_data, 8 );
+    CHECK( __ring_count(&ring) == 0 && __ring_space(&ring) == 8 );
+    CHECK( __ring_get(&ring) == -1 );
+    CHECK( __ring_read(&ring, buf, sizeof(buf)) == 0 );
+
+    // a ring holds exactly 'size' bytes
+    for( uint32 i = 0; i < 8; ++i ) {
+        CHECK( __ring_put(&ring, 'a' + i) );
+    }
+    CHECK( !__ring_put(&ring, 'x') );
+    CHECK( __ring_write(&ring, "x", 1) == 0 );
+    CHECK( __ring_count(&ring) == 8 && __ring_space(&ring) == 0 );
+    CHECK( __ring_peek(&ring, 7) == 'h' && __ring_peek(&ring, 8) == -1 );
+    CHECK( __ring_find(&ring, 'c', 8) == 3 );
+    CHECK( __ring_find(&ring, 'z', 5) == 5 );
+
+    // bytes come out in order, and bulk transfers wrap around the end
+    CHECK( __ring_get(&ring) == 'a' );
+    CHECK( __ring_read(&ring, buf, 5) == 5 );
+    buf[5] = '\0';
+    CHECK_STR( (char *) buf, "bcdef" );
+    CHECK( __ring_write(&ring, "ijklmnopq", 9) == 6 );
+    CHECK( __ring_count(&ring) == 8 );
+    CHECK( __ring_read(&ring, buf, sizeof(buf)) == 8 );
+    buf[8] = '\0';
+    CHECK_STR( (char *) buf, "ghijklmn" );
+
+    // the indices run freely; keep going around the ring a while
+    for( uint32 i = 0; i < 1000 && ok; ++i ) {
+        buf[7] = '\0';
+        ok = __ring_write(&ring, "0123456", 7) == 7
+             && __ring_read(&ring, buf, 7) == 7
+             && __strcmp( (char *) buf, "0123456" ) == 0;
+    }
+    CHECK( ok );
+    CHECK( __ring_count(&ring) == 0 );
+}
+
+/*
+** Process creation tests
+*/
+
+//
+// _test_proc() - check the parent links of new processes
+//
+// init is its own parent, and kernel threads have none.
+//
+static void _test_proc( void ) {
+    static char *argv[] = { "kworker", NULL };
+    uint32 entry = (uint32) _test_proc;
+    Pcb *init = _pcb_alloc();
+    Pcb *kt = _pcb_alloc();
+    Pcb *kid = _pcb_alloc();
+    int pid;
+
+    CHECK( init != NULL && kt != NULL && kid != NULL );
+    if( init == NULL || kt == NULL || kid == NULL ) {
+        return;
+    }
+
+    CHECK( _proc_create(init, &_stacks[0], init, entry, argv) == 1 );
+    CHECK( init->ppid == 1 );
+    CHECK( !IS_KTHREAD(init) );
+
+    // a kernel thread
+    pid = _proc_create( kt, &_stacks[1], NULL, entry, argv );
+    CHECK( pid > 1 );
+    CHECK( kt->ppid == 0 );
+    CHECK( IS_KTHREAD(kt) );
+    CHECK( _pcb_find(pid) == kt );
+    CHECK( init->children == 1 );
+
+    // it starts at its entry point, as if called from exit_helper()
+    uint32 *sp = (uint32 *) (kt->context + 1);
+    CHECK( kt->context->eip == entry );
+    CHECK( sp[0] == (uint32) exit_helper );
+    CHECK( sp[1] == 1 );
+    CHECK_STR( (char *) sp[2], "kworker" );
+
+    // an ordinary child of init
+    pid = _proc_create( kid, &_stacks[2], init, entry, argv );
+    CHECK( pid > 1 && pid != kt->pid );
+    CHECK( kid->ppid == 1 );
+    CHECK( _pcb_find(pid) == kid );
+    CHECK( init->children == 2 );
+}
+
+/*
+** Scheduler tests
+*/
+
+//
+// _test_sched() - check the order in which processes get the CPU
+//
+static void _test_sched( void ) {
+    Pcb *p = _procs;
+
+    __memclr( _procs, sizeof(_procs) );
+    __memclr( &_idle, sizeof(_idle) );
+    _idle_pcb = &_idle;
+    _isr_depth = 1;
+
+    _sched_init();
+    _kready = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    CHECK( _ready != NULL && _kready != NULL );
+    if( _ready == NULL || _kready == NULL ) {
+        return;
+    }
+    __cio_putchar( '\n' );
+
+    // scheduling makes a process ready
+    _schedule( &p[0] );
+    CHECK( p[0].state == READY );
+    CHECK( p[0].queue == _ready );
+    CHECK( _queue_length(_ready) == 1 );
+
+    // dispatching takes the first ready process
+    _schedule( &p[1] );
+    _schedule( &p[2] );
+    uint32 switches = _host_fpu_switches;
+    _dispatch();
+    CHECK( _current == &p[0] );
+    CHECK( p[0].state == RUNNING );
+    CHECK( p[0].queue == NULL );
+    CHECK( p[0].quantum == QUANTUM_STD );
+    CHECK( _host_fpu_switches == switches + 1 );
+    CHECK( _queue_length(_ready) == 2 );
+
+    // preemption is round-robin: p0 goes behind p1 and p2
+    _preempt();
+    CHECK( _current == &p[1] );
+    CHECK( p[0].state == READY );
+    _preempt();
+    CHECK( _current == &p[2] );
+    _preempt();
+    CHECK( _current == &p[0] );
+    CHECK( _queue_length(_ready) == 2 );
+
+    // kernel threads with work to do go ahead of everyone
+    _queue_enque( _kready, &p[3] );
+    _preempt();
+    CHECK( _current == &p[3] );
+    CHECK( _queue_front(_ready) == &p[1] );
+    CHECK( _queue_length(_kready) == 0 );
+    CHECK( _queue_length(_ready) == 3 );
+
+    // inside a nested interrupt, preemption is only noted...
+    _isr_depth = 2;
+    _preempt();
+    CHECK( _current == &p[3] );
+    CHECK( p[3].state == RUNNING );
+    CHECK( _need_resched );
+
+    // ...and happens when the system call finishes
+    _isr_depth = 1;
+    _resched();
+    CHECK( !_need_resched );
+    CHECK( _current == &p[1] );
+
+    // unless the call gave up the CPU itself
+    _need_resched = true;
+    p[1].state = BLOCKED;
+    _resched();
+    CHECK( !_need_resched );
+    CHECK( _current == &p[1] );
+
+    // with nobody ready, the rings are polled and idle() runs
+    while( _queue_deque(_ready) != NULL ) {
+        ;
+    }
+    uint32 polls = _host_ring_polls;
+    _dispatch();
+    CHECK( _current == &_idle );
+    CHECK( _host_ring_polls == polls + 1 );
+
+    // and idle() never goes on the ready queue
+    _preempt();
+    CHECK( _current == &_idle );
+    CHECK( _queue_length(_ready) == 0 );
+
+    // a process which becomes ready replaces it
+    _schedule( &p[2] );
+    _preempt();
+    CHECK( _current == &p[2] );
+    CHECK( _queue_length(_ready) == 0 );
+
+    _current = NULL;
+}
+
+/*
+** Benchmarks
+*/
+
+//
+// _bench_start() - start timing a run
+//
+static void _bench_start( Best *start ) {
+
+    start->ns = (uint32) _host_ns();
+    start->cycles = (uint32) __rdtsc();
+}
+
+//
+// _bench_end() - finish timing a run, keeping the best time
+//
+static void _bench_end( Best *best, Best *start ) {
+    uint32 ns = (uint32) _host_ns() - start->ns;
+    uint32 cycles = (uint32) __rdtsc() - start->cycles;
+
+    if( ns < best->ns ) {
+        best->ns = ns;
+    }
+    if( cycles < best->cycles ) {
+        best->cycles = cycles;
+    }
+}
+
+//
+// _bench_tenths() - the time per operation of the best run, in 0.1ns
+//
+static uint32 _bench_tenths( Best *best, uint32 ops ) {
+
+    // avoid overflowing (or dividing) 32 bits
+    if( best->ns < 0xffffffff / 10 ) {
+        return( best->ns * 10 / ops );
+    }
+    return( best->ns / ops * 10 );
+}
+
+//
+// _bench_report() - print the time per operation of the best run
+//
+static void _bench_report( Best *best, uint32 ops ) {
+    uint32 tenths = _bench_tenths( best, ops );
+
+    __cio_printf( " %6d.%d ns %7d cyc", tenths / 10, tenths % 10,
+                  best->cycles / ops );
+}
+
+//
+// _bench_fifo() - time a FIFO queue which is kept at a constant length
+//
+// Each operation moves the entry at the front of the queue to the end,
+// as the ready queue does for processes which use up their quantum.
+//
+static void _bench_fifo( void ) {
+    Queue q = _queue_alloc( NULL, QOFFSET(Item,link) );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    if( q == NULL ) {
+        __cio_puts( "bench: can't allocate queue\n" );
+        return;
+    }
+
+    _items_reset( 16 );
+    for( uint32 i = 0; i < 16; ++i ) {
+        _queue_enque( q, &_items[i] );
+    }
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < BENCH_OPS; ++i ) {
+            _queue_enque( q, _queue_deque(q) );
+        }
+        _bench_end( &best, &start );
+    }
+
+    while( _queue_deque(q) != NULL ) {
+        ;
+    }
+    _queue_free( q );
+
+    __cio_puts( "FIFO deque+enque (16 entries)       " );
+    _bench_report( &best, BENCH_OPS );
+    __cio_putchar( '\n' );
+}
+
+//
+// _bench_order() - time filling and then emptying an ordered queue
+//
+// Reports the time per insertion and per removal.
+//
+static void _bench_order( Queue q, uint32 n ) {
+    Best enq = { BENCH_NONE, BENCH_NONE };
+    Best deq = { BENCH_NONE, BENCH_NONE };
+    Best start;
+    uint32 seed = 12345;
+
+    // the same keys every time
+    _items_reset( n );
+    for( uint32 i = 0; i < n; ++i ) {
+        _items[i].key = _random( &seed );
+    }
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < n; ++i ) {
+            _queue_enque( q, &_items[i] );
+        }
+        _bench_end( &enq, &start );
+
+        _bench_start( &start );
+        while( _queue_deque(q) != NULL ) {
+            ;
+        }
+        _bench_end( &deq, &start );
+    }
+
+    _bench_report( &enq, n );
+    _bench_report( &deq, n );
+}
+
+//
+// _bench_queues() - compare the sorted list and heap organizations
+//
+static void _bench_queues( void ) {
+    Queue heap = _queue_alloc( _item_cmp, QOFFSET(Item,link) );
+    Queue sorted = _queue_alloc_sorted( _item_cmp, QOFFSET(Item,link) );
+
+    _bench_fifo();
+
+    if( heap == NULL || sorted == NULL ) {
+        __cio_puts( "bench: can't allocate queue\n" );
+        return;
+    }
+
+    for( uint32 n = 10; n <= BENCH_ORDER_MAX; n *= 10 ) {
+        __cio_printf( "sorted enque, deque (%5d entries)  ", n );
+        _bench_order( sorted, n );
+        __cio_printf( "\nheap   enque, deque (%5d entries)  ", n );
+        _bench_order( heap, n );
+        __cio_putchar( '\n' );
+    }
+
+    _queue_free( heap );
+    _queue_free( sorted );
+}
+
+//
+// _bench_format() - time __sprint() with a few representative formats
+//
+static void _bench_format( void ) {
+    static const struct {
+        char *label;
+        char *fmt;
+    } tests[] = {
+        { "none", "no conversions at all" },
+        { "s",    "%s: no such process" },
+        { "sd",   "%s: PID %d" },
+        { "sdx",  "%s: PID %d at %08x" }
+    };
+    char buf[ 64 ];
+
+    for( uint32 t = 0; t < sizeof(tests) / sizeof(tests[0]); ++t ) {
+        Best best = { BENCH_NONE, BENCH_NONE };
+        Best start;
+
+        for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+            _bench_start( &start );
+            for( uint32 i = 0; i < BENCH_OPS; ++i ) {
+                __sprint( buf, tests[t].fmt, "kernel", -1234567, 0xdeadbeef );
+            }
+            _bench_end( &best, &start );
+        }
+        __cio_printf( "__sprint %-4s                       ", tests[t].label );
+        _bench_report( &best, BENCH_OPS );
+        __cio_putchar( '\n' );
+    }
+}
+
+//
+// _bench_sched() - time the schedule/dispatch cycle
+//
+// Each cycle is what happens when the current process is preempted:
+// it is put on the ready queue, and the next ready process becomes
+// current.
+//
+static void _bench_sched( void ) {
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    __memclr( _procs, sizeof(_procs) );
+    _current = &_procs[0];
+    for( uint32 i = 1; i < N_TEST_PROCS; ++i ) {
+        _schedule( &_procs[i] );
+    }
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < BENCH_OPS; ++i ) {
+            _schedule( _current );
+            _dispatch();
+        }
+        _bench_end( &best, &start );
+    }
+
+    while( _queue_deque(_ready) != NULL ) {
+        ;
+    }
+    _current = NULL;
+
+    __cio_printf( "schedule+dispatch (%d ready)          ",
+                  N_TEST_PROCS - 1 );
+    _bench_report( &best, BENCH_OPS );
+    __cio_putchar( '\n' );
+}
+
+/*
+** The original byte-at-a-time memory and string routines, for comparison
+*/
+
+static void _byte_memcpy( void *dst, const void *src, uint32 len ) {
+    register uint8 *dest = dst;
+    register const uint8 *source = src;
+
+    while( len-- ) {
+        *dest++ = *source++;
+    }
+}
+
+static void _byte_memset( void *buf, uint32 len, uint32 value ) {
+    register uint8 *bp = buf;
+
+    while( len-- ) {
+        *bp++ = value;
+    }
+}
+
+static uint32 _byte_strlen( register const char *str ) {
+    register uint32 len = 0;
+
+    while( *str++ ) {
+        ++len;
+    }
+    return( len );
+}
+
+static int _byte_strcmp( register const char *s1, register const char *s2 ) {
+
+    while( *s1 && (*s1 == *s2) )
+        ++s1, ++s2;
+
+    return( *s1 - *s2 );
+}
+
+//
+// _mem_iters() - how many times to repeat an operation on 'len' bytes
+//
+static uint32 _mem_iters( uint32 len ) {
+    uint32 n = BENCH_MEM_BYTES / len;
+
+    return( n < 16 ? 16 : n );
+}
+
+//
+// _mem_report() - print the time per call of the best run, in ns
+//
+static void _mem_report( Best *best, uint32 iters ) {
+    uint32 tenths = _bench_tenths( best, iters );
+
+    __cio_printf( " %7d.%d", tenths / 10, tenths % 10 );
+}
+
+//
+// _bench_copy() - time a memcpy implementation
+//
+static void _bench_copy( void (*fcn)(void *,const void *,uint32), uint32 len ) {
+    uint32 iters = _mem_iters( len );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < iters; ++i ) {
+            fcn( _dst, _src, len );
+        }
+        _bench_end( &best, &start );
+    }
+    _mem_report( &best, iters );
+}
+
+//
+// _bench_set() - time a memset implementation
+//
+static void _bench_set( void (*fcn)(void *,uint32,uint32), uint32 len ) {
+    uint32 iters = _mem_iters( len );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < iters; ++i ) {
+            fcn( _dst, len, 0 );
+        }
+        _bench_end( &best, &start );
+    }
+    _mem_report( &best, iters );
+}
+
+//
+// _bench_strlen() - time a strlen implementation on a 'len'-byte string
+//
+static void _bench_strlen( uint32 (*fcn)(const char *), uint32 len ) {
+    uint32 iters = _mem_iters( len );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < iters; ++i ) {
+            fcn( (const char *) _src );
+        }
+        _bench_end( &best, &start );
+    }
+    _mem_report( &best, iters );
+}
+
+//
+// _bench_strcmp() - time a strcmp implementation on equal strings
+//
+static void _bench_strcmp( int (*fcn)(const char *,const char *),
+                           uint32 len ) {
+    uint32 iters = _mem_iters( len );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < iters; ++i ) {
+            fcn( (const char *) _dst, (const char *) _src );
+        }
+        _bench_end( &best, &start );
+    }
+    _mem_report( &best, iters );
+}
+
+//
+// _bench_mem() - compare the memory and string routines with the
+// original byte-at-a-time loops
+//
+// All of the string instruction versions are timed, whether or not
+// __mem_init() would choose them on this CPU.
+//
+static void _bench_mem( void ) {
+
+    _byte_memset( _src, BENCH_MEM_MAX, 0x5a );
+
+    __cio_puts( "\nns/call for memcpy (cpy), memset (set), strlen (len)"
+                " and strcmp (cmp):\n" );
+    __cio_puts( "   bytes  cpy byte cpy movsl cpy movsb"
+                "  set byte set stosl set stosb\n" );
+
+    for( uint32 len = 1; len <= BENCH_MEM_MAX; len *= 4 ) {
+        __cio_printf( "%8d", len );
+        _bench_copy( _byte_memcpy, len );
+        _bench_copy( __memcpy_movsl, len );
+        _bench_copy( __memcpy_movsb, len );
+        _bench_set( _byte_memset, len );
+        _bench_set( __memset_stosl, len );
+        _bench_set( __memset_stosb, len );
+        __cio_putchar( '\n' );
+    }
+
+    __cio_puts( "   bytes  len byte  len word  cmp byte  cmp word\n" );
+
+    for( uint32 len = 1; len <= BENCH_MEM_MAX; len *= 4 ) {
+        // two equal strings of 'len - 1' characters
+        _byte_memset( _src, len - 1, 'x' );
+        _src[len - 1] = 0;
+        _byte_memcpy( _dst, _src, len );
+
+        __cio_printf( "%8d", len );
+        _bench_strlen( _byte_strlen, len );
+        _bench_strlen( __strlen, len );
+        _bench_strcmp( _byte_strcmp, len );
+        _bench_strcmp( __strcmp, len );
+        __cio_putchar( '\n' );
+    }
+}
+
+//
+// _ring_bytes() - move 'len' bytes through a ring a byte at a time
+//
+static void _ring_bytes( Ring *ring, uint32 len ) {
+
+    for( uint32 i = 0; i < len; ++i ) {
+        __ring_put( ring, _src[i] );
+    }
+    for( uint32 i = 0; i < len; ++i ) {
+        _dst[i] = __ring_get( ring );
+    }
+}
+
+//
+// _ring_bulk() - move 'len' bytes through a ring in one piece
+//
+static void _ring_bulk( Ring *ring, uint32 len ) {
+
+    __ring_write( ring, _src, len );
+    __ring_read( ring, _dst, len );
+}
+
+//
+// _bench_ring() - time a way of moving data through a ring
+//
+static void _bench_ring( void (*fcn)(Ring *,uint32), Ring *ring,
+                         uint32 len ) {
+    uint32 iters = _mem_iters( len );
+    Best best = { BENCH_NONE, BENCH_NONE };
+    Best start;
+
+    for( uint32 r = 0; r < BENCH_REPS; ++r ) {
+        _bench_start( &start );
+        for( uint32 i = 0; i < iters; ++i ) {
+            fcn( ring, len );
+        }
+        _bench_end( &best, &start );
+    }
+    _mem_report( &best, iters );
+}
+
+//
+// _bench_rings() - compare byte-at-a-time and bulk ring transfers
+//
+// Each transfer starts where the last one ended, so most chunks larger
+// than a byte wrap around the end of the ring now and then.
+//
+static void _bench_rings( void ) {
+    Ring ring;
+
+    __ring_init( &ring, _ring_data, BENCH_RING_SIZE );
+    __memset( _src, BENCH_RING_MAX, 0x5a );
+
+    __cio_puts( "\nns/call to move data through a ring, a byte at a time"
+                " or in bulk:\n" );
+    __cio_puts( "   bytes      byte      bulk\n" );
+
+    for( uint32 len = 1; len <= BENCH_RING_MAX; len *= 4 ) {
+        __cio_printf( "%8d", len );
+        _bench_ring( _ring_bytes, &ring, len );
+        _bench_ring( _ring_bulk, &ring, len );
+        __cio_putchar( '\n' );
+    }
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _host_main() - run the tests and benchmarks
+//
+// @returns The exit status for the program (HOST_*)
+//
+int _host_main( void ) {
+
+    __cio_puts( "Init:" );
+    _queue_init();
+    _proc_init();
+
+    _test_queues();
+    _test_ring();
+    _test_format();
+    _test_proc();
+    _test_sched();
+
+    __cio_printf( "%d checks, %d failed\n", _checks, _failures );
+    if( _failures > 0 ) {
+        return( HOST_FAILED );
+    }
+
+    __cio_printf( "\nBest of %d runs, per operation:\n", BENCH_REPS );
+    _bench_queues();
+    _bench_format();
+    _bench_sched();
+    _bench_rings();
+    _bench_mem();
+
+    return( HOST_PASSED );
+}
@@ -0,0 +1,86 @@
+/*
+** SCCS ID:	@(#)hosttest.h	1.1	3/30/20
+**
+** File:	hosttest.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Hosted test program declarations
+**
+** The queue, ring buffer, scheduler and formatting modules are also
+** linked, exactly as they are compiled for the OS, into an ordinary
+** 32-bit Linux program ('make hosttest').  hosttest.c holds its unit tests and
+** microbenchmarks; hoststubs.c holds its start-up code, the Linux
+** system calls it makes (it has no C library), and stand-ins for the
+** parts of the OS which the modules use but which are not under test.
+**
+** Console output goes to the standard output.  A failed assertion in
+** the modules reaches __panic(), which reports it and exits with the
+** status HOST_PANICKED.
+*/
+
+#ifndef _HOSTTEST_H_
+#define _HOSTTEST_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+// exit status of the test program
+
+#define	HOST_PASSED	0
+#define	HOST_FAILED	1
+#define	HOST_PANICKED	2
+
+// slices and pages of memory available to _kalloc_slice() and
+// _kalloc_page()
+
+#define	HOST_SLICES	64
+#define	HOST_PAGES	8
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Globals
+*/
+
+// how often some of the stand-ins have been called
+
+extern uint32 _host_fpu_switches;   // _fpu_switch()
+extern uint32 _host_ring_polls;     // _sys_ring_poll()
+extern uint32 _host_warnings;       // _klog()
+
+/*
+** Prototypes
+*/
+
+//
+// _host_main() - run the tests and benchmarks
+//
+// @returns The exit status for the program (HOST_*)
+//
+int _host_main( void );
+
+//
+// _host_write() - write to the standard output
+//
+void _host_write( const char *buf, uint32 length );
+
+//
+// _host_ns() - read the host's monotonic clock
+//
+// @returns The time, in nanoseconds
+//
+uint64 _host_ns( void );
+
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/*
+** SCCS ID:	@(#)irqstat.c	1.1	3/30/20
+**
+** File:	irqstat.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Interrupt statistics implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include <x86arch.h>
+
+#include "common.h"
+
+#include "support.h"
+#include "irqstat.h"
+#include "clock.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// the first histogram bucket counts delays below 2^IRQ_HIST_SHIFT cycles
+
+#define	IRQ_HIST_SHIFT	6
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+// the second-level ISR table (defined in support.c)
+extern void ( *__isr_table[ 256 ] )( int vector, int code );
+
+#ifdef ISR_STATS
+static IrqInfo _irq_stats[ 256 ];
+
+// clock tick lateness histogram, and the time of the previous tick
+static uint32 _irq_late[ IRQ_HIST_SIZE ];
+static uint64 _irq_last_tick;
+#endif
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+#ifdef ISR_STATS
+uint64 _irq_entry_tsc;
+#endif
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+#ifdef ISR_STATS
+//
+// _irq_bucket() - select the histogram bucket for a cycle count
+//
+static uint32 _irq_bucket( uint32 cycles ) {
+
+    if( cycles < (1 << IRQ_HIST_SHIFT) ) {
+        return( 0 );
+    }
+
+    uint32 n = (31 - __builtin_clz(cycles)) - IRQ_HIST_SHIFT + 1;
+
+    return( n < IRQ_HIST_SIZE ? n : IRQ_HIST_SIZE - 1 );
+}
+
+//
+// _irq_tick() - record the lateness of a clock tick
+//
+// @param entry   TSC value on entry to the stub
+//
+static void _irq_tick( uint64 entry ) {
+    uint32 expected = _time_page->tsc_per_tick;
+
+    // until the TSC rate is known, there's nothing to compare against
+    if( expected != 0 && _irq_last_tick != 0 ) {
+        uint32 delta = (uint32) (entry - _irq_last_tick);
+        uint32 late = delta > expected ? delta - expected : 0;
+        _irq_late[ _irq_bucket(late) ] += 1;
+    }
+
+    _irq_last_tick = entry;
+}
+#endif
+
+//
+// _irq_print_hist() - print one histogram on a single line
+//
+static void _irq_print_hist( const uint32 *hist ) {
+
+    for( int i = 0; i < IRQ_HIST_SIZE; ++i ) {
+        __cio_printf( " %d", hist[i] );
+    }
+    __cio_putchar( '\n' );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _irq_init() - initialize the interrupt statistics module
+//
+void _irq_init( void ) {
+
+#ifdef ISR_STATS
+    __memclr( _irq_stats, sizeof(_irq_stats) );
+    __memclr( _irq_late, sizeof(_irq_late) );
+    _irq_last_tick = 0;
+#endif
+
+    __cio_puts( " IRQSTAT" );
+}
+
+//
+// _irq_dispatch() - time and call the handler for an interrupt
+//
+void _irq_dispatch( int vector, int code ) {
+
+#ifdef ISR_STATS
+    uint64 entry = _irq_entry_tsc;
+    uint64 start = __rdtsc();
+
+    if( vector == INT_VEC_TIMER ) {
+        _irq_tick( entry );
+    }
+
+    __isr_table[ vector ]( vector, code );
+
+    _irq_account( vector, entry, start );
+#else
+    __isr_table[ vector ]( vector, code );
+#endif
+}
+
+//
+// _irq_account() - record one handler run
+//
+void _irq_account( int vector, uint64 entry, uint64 start ) {
+
+#ifdef ISR_STATS
+    uint32 cycles = (uint32) (__rdtsc() - start);
+    IrqInfo *info = &_irq_stats[ vector & 0xff ];
+
+    info->count += 1;
+    info->cycles += cycles;
+    if( cycles > info->max ) {
+        info->max = cycles;
+    }
+    info->hist[ _irq_bucket((uint32) (start - entry)) ] += 1;
+#endif
+}
+
+//
+// _irq_get() - copy statistics for the vectors which have been used
+//
+int _irq_get( IrqInfo *buf, uint32 count ) {
+    uint32 n = 0;
+
+#ifdef ISR_STATS
+    for( int i = 0; i < 256 && n < count; ++i ) {
+        if( _irq_stats[i].count > 0 ) {
+            buf[n] = _irq_stats[i];
+            buf[n].vector = i;
+            ++n;
+        }
+    }
+#endif
+
+    return( n );
+}
+
+//
+// _irq_dump() - print interrupt statistics on the console
+//
+void _irq_dump( void ) {
+
+#ifdef ISR_STATS
+    __cio_puts( "\nvec      count     avg     max  entry delay histogram\n" );
+    for( int i = 0; i < 256; ++i ) {
+        IrqInfo *info = &_irq_stats[i];
+        if( info->count > 0 ) {
+            // the totals fit in 32 bits for any reasonable run
+            __cio_printf( " %02x %10d %7d %7d:", i, info->count,
+                          (uint32) info->cycles / info->count, info->max );
+            _irq_print_hist( info->hist );
+        }
+    }
+    __cio_printf( "clock tick lateness (buckets from %d cycles):",
+                  1 << IRQ_HIST_SHIFT );
+    _irq_print_hist( _irq_late );
+#else
+    __cio_puts( "\ninterrupt statistics not compiled in (ISR_STATS)\n" );
+#endif
+}
@@ -0,0 +1,95 @@
+/*
+** SCCS ID:	@(#)irqstat.h	1.1	3/30/20
+**
+** File:	irqstat.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Interrupt statistics declarations
+**
+** When compiled with ISR_STATS, the interrupt and system call entry
+** stubs record the TSC on entry, and every handler run is timed.  For
+** each vector we keep a count, the total and maximum handler cycles,
+** and a histogram of the delay between entry to the stub and the call
+** of the handler.  For the clock we also keep a histogram of how late
+** each tick arrived, measured against the TSC rate in the time page;
+** this shows how long interrupts were being held off.
+*/
+
+#ifndef _IRQSTAT_H_
+#define _IRQSTAT_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Types
+*/
+
+/*
+** Globals
+*/
+
+#ifdef ISR_STATS
+// TSC value recorded by the most recent interrupt or system call entry
+extern uint64 _irq_entry_tsc;
+#endif
+
+/*
+** Prototypes
+*/
+
+//
+// _irq_init() - initialize the interrupt statistics module
+//
+void _irq_init( void );
+
+//
+// _irq_dispatch() - time and call the handler for an interrupt
+//
+// Called from isr_save (in isr_stubs.S) in place of the direct call
+// through __isr_table.
+//
+// @param vector   The interrupt vector
+// @param code     The error code (or 0)
+//
+void _irq_dispatch( int vector, int code );
+
+//
+// _irq_account() - record one handler run
+//
+// @param vector   The vector that was handled
+// @param entry    TSC value on entry to the stub
+// @param start    TSC value when the handler was called
+//
+void _irq_account( int vector, uint64 entry, uint64 start );
+
+//
+// _irq_get() - copy statistics for the vectors which have been used
+//
+// @param buf      Where to put them
+// @param count    How many entries will fit in 'buf'
+//
+// @returns The number of entries filled in
+//
+int _irq_get( IrqInfo *buf, uint32 count );
+
+//
+// _irq_dump() - print interrupt statistics on the console
+//
+void _irq_dump( void );
+
+#endif
+
+#endif
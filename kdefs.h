@@ -21,6 +21,7 @@
 #include "support.h"
 #include "kernel.h"
 #include "klib.h"
+#include "klog.h"
 
 #ifndef __SP_ASM__
 
@@ -42,18 +43,17 @@
 
 // Debugging and sanity-checking macros
 
-// Warning messages to the console
+// Warning messages to the kernel log
 
 #define WARNING(m)  { \
-        __cio_printf( "WARN %s (%s @ %s): ", __func__, __FILE__, __LINE__ ); \
-        __cio_puts( m ); \
-        __cio_putchar( '\n' ); \
+        _klog( KLOG_WARN, "%s (%s @ %d): %s", \
+               __func__, __FILE__, __LINE__, m ); \
     }
 
 // Panic messages to the console
 
 #define PANIC(n,x)  { \
-        __sprint( b512, "ASSERT %s (%s @ %s), %d: ", \
+        __sprint( b512, "ASSERT %s (%s @ %d), %d: ", \
                   __func__, __FILE__, __LINE__, n ); \
         _kpanic( b512, # x ); \
     }
@@ -21,8 +21,15 @@
 #include "bootstrap.h"
 #include "syscalls.h"
 #include "cio.h"
+#include "cons.h"
 #include "sio.h"
 #include "scheduler.h"
+#include "kthread.h"
+#include "fpu.h"
+#include "cpu_features.h"
+#include "bench.h"
+#include "irqstat.h"
+#include "klog.h"
 #include "pci.h"
 #include "usb.h"
 
@@ -33,6 +40,11 @@
 ** PRIVATE DEFINITIONS
 */
 
+#ifdef CONSOLE_SHELL
+// the key which starts the shell (ESC); others are console input
+#define	SHELL_KEY	'\033'
+#endif
+
 /*
 ** PRIVATE DATA TYPES
 */
@@ -41,6 +53,11 @@
 ** PRIVATE GLOBAL VARIABLES
 */
 
+#ifdef CONSOLE_SHELL
+// is the shell running (or about to)?
+static bool _in_shell;
+#endif
+
 /*
 ** PUBLIC GLOBAL VARIABLES
 */
@@ -66,9 +83,6 @@ Pcb *_init_pcb;
 Pid _idle_pid;
 Pcb *_idle_pcb;
 
-// Static array of PCBs
-Pcb _pcbs[ N_PROCS ];
-
 // Count of active processes
 uint32 _active;
 
@@ -77,21 +91,58 @@ Pid _next_pid;
 
 // Queues (used by multiple modules)
 Queue _waiting;   // processes waiting (for Godot?)
-Queue _reading;   // processes blocked on input
 Queue _zombie;    // gone, but not forgotten
 Queue _sleeping;  // processes catching some Z
 Queue _ready;     // processes which are ready to execute
 
-// A separate stack for the OS itself
-// (NOTE:  this assumes the OS is not reentrant!)
+// A separate stack for the OS itself; used during system
+// initialization, and briefly by the SYSENTER entry path
+// (interrupt handlers and system calls use the kernel stack
+// of the current process)
 Stack *_system_stack;
 uint32 *_system_esp;
 
+// Interrupt/system call nesting depth (managed by isr_stubs.S)
+uint32 _isr_depth;
+
 
 /*
 ** PRIVATE FUNCTIONS
 */
 
+#ifdef CONSOLE_SHELL
+/*
+** _shell_work - run the shell (deferred work)
+*/
+static void _shell_work( uint32 ch ) {
+    _shell( ch );
+    _in_shell = false;
+}
+
+/*
+** _kbd_notify - console input notification
+**
+** Called by the keyboard ISR when a character arrives.  SHELL_KEY
+** starts the shell, which is run by the kernel worker thread with
+** interrupts enabled and reads its own input; otherwise, the input
+** goes to processes reading the console.
+*/
+static void _kbd_notify( int ch ) {
+    if( _in_shell ) {
+        return;
+    }
+    if( ch == SHELL_KEY ) {
+        _in_shell = true;
+        // the shell talks through the console, so it must be seen
+        _cons_focus( NULL );
+        _kthread_defer( _shell_work, 'h' );
+        _kthread_preempt();
+        return;
+    }
+    _cons_notify( ch );
+}
+#endif
+
 /*
 ** PUBLIC FUNCTIONS
 */
@@ -121,7 +172,12 @@ void _init( void ) {
     ** and queue modules.
     */
 
-    __cio_init( NULL );    // no console callback routine
+#ifdef CONSOLE_SHELL
+    _in_shell = false;
+    __cio_init( _kbd_notify );   // start the shell on console input
+#else
+    __cio_init( _cons_notify );   // console input for processes
+#endif
 
 #ifdef TRACE_CX
     __cio_setscroll( 0, 7, 99, 99 );
@@ -144,15 +200,20 @@ void _init( void ) {
 
     __cio_puts( "Modules:" );
 
-    _kmem_init();    // kernel memory system (must be first)
-    _queue_init();   // queues (must be second)
+    _cpu_init();     // CPU features (must be first)
+    __mem_init();    // memory routines for this CPU
+    _kmem_init();    // kernel memory system (must be second)
+    _queue_init();   // queues (must be third)
 
     _clk_init();     // clock
     _proc_init();    // processes
     _sched_init();   // scheduler
     _sio_init();     // serial i/o
+    _cons_init();    // console input
     _stk_init();     // stacks
     _sys_init();     // system calls
+    _irq_init();     // interrupt statistics
+    _fpu_init();     // FPU and SSE
     _pci_init();     // PCI
     _usb_init();     // USB
 
@@ -227,11 +288,20 @@ void _init( void ) {
     _active += 1;
 
     /*
-    ** Turn on the SIO receiver (the transmitter will be turned
+    ** Start the kernel threads.  This is done after init and
+    ** idle are created so that they get the first two PIDs.
+    */
+
+    _kthread_init();
+
+    /*
+    ** Turn on the SIO receivers (the transmitters will be turned
     ** on/off as characters are being sent)
     */
 
-    _sio_enable( SIO_RX );
+    for( int port = 0; port < SIO_PORTS; ++port ) {
+        _sio_enable( port, SIO_RX );
+    }
 
     // dispatch the first user process
 
@@ -279,7 +349,8 @@ void _shell( int ch ) {
         case 'q':  // dump the queues
             _queue_dump( "Sleep queue", _sleeping );
             _queue_dump( "Waiting queue", _waiting );
-            _queue_dump( "Reading queue", _reading );
+            _cons_queue_dump();
+            _sio_queue_dump();
             _queue_dump( "Zombie queue", _zombie );
             _queue_dump( "Ready queue", _ready );
             break;
@@ -298,16 +369,40 @@ void _shell( int ch ) {
 
         case 's':  // dump stack info for all active PCBS
             __cio_puts( "\nActive stacks (w/5-sec. delays):\n" );
-            for( int i = 0; i < N_PROCS; ++i ) {
-                if( _pcbs[i].state != UNUSED ) {
-                    Pcb *pcb = &_pcbs[i];
-                    __cio_printf( "pid %5d: ", pcb->pid );
-                    __cio_printf( "EIP %08x, ", pcb->context->eip );
-                    _stk_dump( NULL, pcb->stack, 12 );
-                    __delay( 200 );
-                }
+            for( Pcb *pcb = _pcb_first(); pcb != NULL; pcb = _pcb_next(pcb) ) {
+                __cio_printf( "pid %5d: ", pcb->pid );
+                __cio_printf( "EIP %08x, ", pcb->context->eip );
+                _stk_dump( NULL, pcb->stack, 12 );
+                __delay( 200 );
             }
             break;
+        case 'k':  // dump deferred work statistics
+            _kthread_dump();
+            break;
+        case 'b':  // run the benchmarks
+            _bench_run();
+            break;
+        case 'f':  // dump FPU statistics
+            _fpu_dump();
+            break;
+        case 'm':  // dump CPU features
+            _cpu_dump();
+            break;
+        case 'i':  // dump interrupt statistics
+            _irq_dump();
+            break;
+        case 'o':  // dump serial i/o statistics
+            _sio_stats();
+            break;
+        case 'd':  // dump the kernel log
+            _klog_dump();
+            break;
+        case 'v':  // toggle draining of debug messages
+            _klog_drain ^= KLOG_MASK(KLOG_DEBUG);
+            __cio_printf( "\nDebug messages %s\n",
+                (_klog_drain & KLOG_MASK(KLOG_DEBUG)) ? "on" : "off" );
+            break;
+
         case 'l': // List all connected PCI devices
             __cio_puts( "\nPCI Devices:\n" );
 
@@ -327,13 +422,21 @@ void _shell( int ch ) {
         case 'h':  // help message
             __cio_puts( "\nCommands:\n" );
             __cio_puts( "   a  -- dump the active table\n" );
+            __cio_puts( "   b  -- run the benchmarks\n" );
             __cio_puts( "   c  -- dump contexts for active processes\n" );
+            __cio_puts( "   d  -- dump the kernel log\n" );
+            __cio_puts( "   f  -- dump FPU statistics\n" );
             __cio_puts( "   h  -- this message\n" );
+            __cio_puts( "   i  -- dump interrupt statistics\n" );
+            __cio_puts( "   k  -- dump deferred work statistics\n" );
+            __cio_puts( "   m  -- dump CPU features\n" );
+            __cio_puts( "   o  -- dump serial i/o statistics\n" );
             __cio_puts( "   p  -- dump the active table and all PCBs\n" );
             __cio_puts( "   q  -- dump the queues\n" );
             __cio_puts( "   s  -- dump stacks for active processes\n" );
             __cio_puts( "   l  -- list all PCI devices\n");
             __cio_puts( "   u  -- get the status of the USB controller\n" );
+            __cio_puts( "   v  -- toggle debug messages on the console\n" );
             __cio_puts( "   x  -- exit\n" );
             break;
         }
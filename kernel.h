@@ -65,9 +65,6 @@ extern Pcb *_init_pcb;
 extern Pid _idle_pid;
 extern Pcb *_idle_pcb;
 
-// Static array of PCBs
-extern Pcb _pcbs[];
-
 // Count of active processes
 extern uint32 _active;
 
@@ -76,16 +73,20 @@ extern Pid _next_pid;
 
 // Queues (used by multiple modules)
 extern Queue _waiting;   // processes waiting (for Godot?)
-extern Queue _reading;   // processes blocked on input
 extern Queue _zombie;    // gone, but not forgotten
 extern Queue _sleeping;  // processes catching some Z
 extern Queue _ready;     // processes which are ready to execute
 
-// A separate stack for the OS itself
-// (NOTE:  this assumes the OS is not reentrant!)
+// A separate stack for the OS itself; used during system
+// initialization, and briefly by the SYSENTER entry path
+// (interrupt handlers and system calls use the kernel stack
+// of the current process)
 extern Stack *_system_stack;
 extern uint32 *_system_esp;
 
+// Interrupt/system call nesting depth (managed by isr_stubs.S)
+extern uint32 _isr_depth;
+
 /*
 ** Prototypes
 */
@@ -15,6 +15,7 @@
 #define _KLIB_H_
 
 #include "types.h"
+#include "wstring.h"
 
 /*
 ** _put_char_or_code( ch )
@@ -38,6 +39,23 @@ void _put_char_or_code( int ch );
 unsigned int __bound( unsigned int min, unsigned int value,
                         unsigned int max );
 
+/*
+** Name:	__mem_init
+**
+** Description:	Choose the block memory routines for this CPU
+*/
+void __mem_init( void );
+
+/*
+** Name:	__memcpy_movsl, __memcpy_movsb, __memset_stosl, __memset_stosb
+**
+** Description:	Implementations of __memcpy() and __memset() (see klibs.S)
+*/
+void __memcpy_movsl( void *dst, const void *src, unsigned int len );
+void __memcpy_movsb( void *dst, const void *src, unsigned int len );
+void __memset_stosl( void *buf, unsigned int len, unsigned int value );
+void __memset_stosb( void *buf, unsigned int len, unsigned int value );
+
 /*
 ** Name:	__memset
 **
@@ -74,43 +92,6 @@ void __memclr( void *buf, register unsigned int len );
 void __memcpy( void *dst, register const void *src,
                register unsigned int len );
 
-/*
-** Name:        __strlen
-**
-** Description: Calculate the length of a C-style string.
-**
-** @param str  The string to examine
-**
-** @returns The length of the string
-*/
-unsigned int __strlen( register const char *str );
-
-/*
-** Name:        __strcmp
-**
-** Description: Compare two strings
-**
-** @param s1   The first string to examine
-** @param s2   The second string to examine
-**
-** @returns < 0 if s1 < s2; 0 if equal; > 0 if s1 > s2
-*/
-int __strcmp( register const char *s1, register const char *s2 );
-
-/*
-** Name:        __strcpy
-**
-** Description: Copy a string into a destination buffer
-**
-** May not correctly deal with overlapping buffers
-**
-** @param dst   The destination buffer
-** @param src   The source buffer
-**
-** @returns The destination buffer
-*/
-char *__strcpy( register char *dst, register const char *src );
-
 /*
 ** Name:	__strcat
 **
@@ -174,6 +155,24 @@ char *__padstr( char *dst, char *str, int len, int width,
 */
 void __sprint( char *dst, char *fmt, ... );
 
+/*
+** Name:        __vsnprint
+**
+** Description: Formatted output into a string buffer of limited size
+**
+** @param dst   The destination buffer
+** @param size  The size of the buffer (including the NUL)
+** @param fmt   The format string
+** @param ap    Pointer to the first parameter for the format string
+**
+** @returns The length of the result string
+**
+** Output which will not fit in the buffer is discarded; the result
+** is always NUL-terminated (if 'size' is not 0).  Variadic functions
+** pass the address just past their format string parameter as 'ap'.
+*/
+int __vsnprint( char *dst, uint32 size, char *fmt, int32 *ap );
+
 /*
 ** Conversion functions
 */
@@ -262,6 +261,32 @@ void __outl( int port, int value );
 */
 unsigned int __get_flags( void );
 
+/*
+** Name:	__set_flags
+**
+** Description:	Set the processor flags
+**
+** @param flags  The new EFLAGS value (usually from __get_flags())
+*/
+void __set_flags( unsigned int flags );
+
+/*
+** Name:	__cli
+**
+** Description:	Disable interrupts
+**
+** Usage:	uint32 flags = __get_flags(); __cli(); ... __set_flags(flags);
+*/
+void __cli( void );
+
+/*
+** Name:	__allow_ints
+**
+** Description:	Let any pending interrupts be serviced, then disable
+**		interrupts again
+*/
+void __allow_ints( void );
+
 /*
 ** Name:	__pause
 **
@@ -279,6 +304,79 @@ void __pause( void );
 */
 uint32 __get_ra( void );
 
+/*
+** Name:	__rdtsc
+**
+** Description:	Read the processor time-stamp counter
+**
+** @returns The current TSC value
+*/
+uint64 __rdtsc( void );
+
+/*
+** Name:	__cpuid
+**
+** Description:	Execute CPUID for the specified function (subleaf 0)
+**
+** @param leaf  The CPUID function number
+** @param regs  Array into which EAX, EBX, ECX and EDX are placed
+*/
+void __cpuid( uint32 leaf, uint32 regs[4] );
+
+/*
+** Name:	__wrmsr
+**
+** Description:	Write a model-specific register
+**
+** @param msr    The MSR number
+** @param value  The value to be written
+*/
+void __wrmsr( uint32 msr, uint64 value );
+
+/*
+** Name:	__get_cr0, __get_cr4
+**
+** Description:	Read control register CR0 or CR4
+**
+** @returns The current contents of the register
+*/
+uint32 __get_cr0( void );
+uint32 __get_cr4( void );
+
+/*
+** Name:	__set_cr0, __set_cr4
+**
+** Description:	Replace the contents of control register CR0 or CR4
+**
+** @param value  The new contents
+*/
+void __set_cr0( uint32 value );
+void __set_cr4( uint32 value );
+
+/*
+** Name:	__clts
+**
+** Description:	Clear the task-switched (TS) flag in CR0
+*/
+void __clts( void );
+
+/*
+** Name:	__fninit
+**
+** Description:	Reset the FPU to its default state
+*/
+void __fninit( void );
+
+/*
+** Name:	__fxsave, __fxrstor
+**
+** Description:	Save or restore the FPU, MMX and SSE state
+**
+** @param area  A 512-byte save area, aligned on a 16-byte boundary
+*/
+void __fxsave( void *area );
+void __fxrstor( void *area );
+
 /*
 ** _kpanic - kernel-level panic routine
 **
@@ -17,6 +17,11 @@
 
 #include "common.h"
 
+#include "cons.h"
+#include "cpu_features.h"
+#include "klog.h"
+#include "sio.h"
+
 /*
 ** _put_char_or_code( ch )
 **
@@ -54,6 +59,41 @@ uint32 __bound( uint32 min, uint32 value,
 	return value;
 }
 
+/*
+** Implementations of the block memory routines
+**
+** These start out as versions which work on any CPU, so that the
+** routines can be used before __mem_init() has been called.
+*/
+
+static void (*_memcpy_impl)( void *, const void *, uint32 ) = __memcpy_movsl;
+static void (*_memset_impl)( void *, uint32, uint32 ) = __memset_stosl;
+
+static const CpuImpl _memcpy_impls[] = {
+	{ CPU_ERMS, __memcpy_movsb, "rep movsb" },
+	{ CPU_ANY,  __memcpy_movsl, "rep movsl" }
+};
+
+static const CpuImpl _memset_impls[] = {
+	{ CPU_ERMS, __memset_stosb, "rep stosb" },
+	{ CPU_ANY,  __memset_stosl, "rep stosl" }
+};
+
+/*
+** Name:        __mem_init
+**
+** Description: Choose the block memory routines for this CPU
+**
+** Must be called after _cpu_init().  The kernel does not use the
+** SSE registers (see fpu.h), so only the string instructions are
+** candidates here.
+*/
+void __mem_init( void ) {
+
+	_memcpy_impl = _cpu_select( "memcpy", _memcpy_impls );
+	_memset_impl = _cpu_select( "memset", _memset_impls );
+}
+
 /*
 ** Name:        __memset
 **
@@ -65,16 +105,8 @@ uint32 __bound( uint32 min, uint32 value,
 */
 void __memset( void *buf, register uint32 len,
                register uint32 value ) {
-	register uint8 *bp = buf;
-
-	/*
-	** We could speed this up by unrolling it and copying
-	** words at a time (instead of bytes).
-	*/
 
-	while( len-- ) {
-		*bp++ = value;
-	}
+	_memset_impl( buf, len, value );
 }
 
 /*
@@ -86,17 +118,8 @@ void __memset( void *buf, register uint32 len,
 ** @param len    Buffer size (in bytes)
 */
 void __memclr( void *buf, register uint32 len ) {
-	register uint8 *dest = buf;
-
-	/*
-	** We could speed this up by unrolling it and clearing
-	** words at a time (instead of bytes).
-	*/
-
-	while( len-- ) {
-     		*dest++ = 0;
-	}
 
+	_memset_impl( buf, len, 0 );
 }
 
 /*
@@ -112,76 +135,8 @@ void __memclr( void *buf, register uint32 len ) {
 */
 void __memcpy( void *dst, register const void *src,
                register uint32 len ) {
-	register uint8 *dest = dst;
-	register const uint8 *source = src;
-
-	/*
-	** We could speed this up by unrolling it and copying
-	** words at a time (instead of bytes).
-	*/
-
-	while( len-- ) {
-		*dest++ = *source++;
-	}
 
-}
-
-/*
-** Name:        __strlen
-**
-** Description: Calculate the length of a C-style string.
-**
-** @param str  The string to examine
-**
-** @returns The length of the string
-*/
-
-uint32 __strlen( register const char *str ){
-	register uint32 len = 0;
-
-	while( *str++ ){
-		++len;
-	}
-	return len;
-}
-
-/*
-** Name:        __strcmp
-**
-** Description: Compare two strings
-**
-** @param s1   The first string to examine
-** @param s2   The second string to examine
-**
-** @returns < 0 if s1 < s2; 0 if equal; > 0 if s1 > s2
-*/
-int __strcmp( register const char *s1, register const char *s2 ) {
-
-	while( *s1 && (*s1 == *s2) )
-		++s1, ++s2;
-
-	return( *s1 - *s2 );
-}
-
-/*
-** Name:        __strcpy
-**
-** Description: Copy a string into a destination buffer
-**
-** May not correctly deal with overlapping buffers
-**
-** @param dst   The destination buffer
-** @param src   The source buffer
-**
-** @returns The destination buffer
-*/
-char *__strcpy( register char *dst, register const char *src ) {
-	char *tmp = dst;
-
-	while( (*dst++ = *src++) )
-		;
-
-	return( tmp );
+	_memcpy_impl( dst, src, len );
 }
 
 /*
@@ -273,23 +228,69 @@ char *__padstr( char *dst, char *str, int len, int width,
 }
 
 /*
-** Name:        __sprint
+** _put_pad( dst, room, extra, padchar )
 **
-** Description: Formatted output into a string buffer
+** bounded version of __pad(); 'room' is the space left in the
+** destination, and is updated
+*/
+static char *_put_pad( char *dst, uint32 *room, int extra, int padchar ) {
+    while( extra > 0 && *room > 0 ){
+        *dst++ = (char) padchar;
+        *room -= 1;
+        extra -= 1;
+    }
+    return dst;
+}
+
+/*
+** _put_field( dst, room, str, len, width, leftadjust, padchar )
+**
+** bounded version of __padstr(); 'room' is the space left in the
+** destination, and is updated
+*/
+static char *_put_field( char *dst, uint32 *room, char *str, int len,
+                         int width, int leftadjust, int padchar ) {
+    int    extra;
+
+    if( len < 0 ){
+        len = __strlen( str );
+    }
+
+    extra = width - len;
+
+    if( extra > 0 && !leftadjust ){
+        dst = _put_pad( dst, room, extra, padchar );
+    }
+
+    for( int i = 0; i < len && *room > 0; ++i ) {
+        *dst++ = str[i];
+        *room -= 1;
+    }
+
+    if( extra > 0 && leftadjust ){
+        dst = _put_pad( dst, room, extra, padchar );
+    }
+
+    return dst;
+}
+
+/*
+** Name:        __vsnprint
+**
+** Description: Formatted output into a string buffer of limited size
 **
 ** @param dst   The destination buffer
+** @param size  The size of the buffer (including the NUL)
 ** @param fmt   The format string
+** @param ap    Pointer to the first parameter for the format string
 **
-** The format string parameter is followed by zero or more additional
-** parameters which are interpreted according to the format string.
-**
-** NOTE:  assumes the buffer is large enough to hold the result string
+** @returns The length of the result string
 **
-** NOTE:  relies heavily on the x86 convention that parameters
-** are pushed onto the stack in reverse order as 32-bit values.
+** Output which will not fit in the buffer is discarded; the result
+** is always NUL-terminated (if 'size' is not 0).
 */
-void __sprint( char *dst, char *fmt, ... ) {
-    int32 *ap;
+int __vsnprint( char *dst, uint32 size, char *fmt, int32 *ap ) {
+    char *start = dst;
     char buf[ 12 ];
     char ch;
     char *str;
@@ -297,6 +298,14 @@ void __sprint( char *dst, char *fmt, ... ) {
     int width;
     int len;
     int padchar;
+    uint32 room;
+
+    if( size == 0 ) {
+        return( 0 );
+    }
+
+    // leave space for the NUL
+    room = size - 1;
 
     /*
     ** Get characters from the format string and process them
@@ -309,9 +318,6 @@ void __sprint( char *dst, char *fmt, ... ) {
     ** to point to the next "thing", and interpret it according
     ** to the format string.
     */
-    
-    // get the pointer to the first "value" parameter
-    ap = (int *)(&fmt) + 1;
 
     // iterate through the format string
     while( (ch = *fmt++) != '\0' ){
@@ -351,38 +357,68 @@ void __sprint( char *dst, char *fmt, ... ) {
                 ch = *ap++;
                 buf[ 0 ] = ch;
                 buf[ 1 ] = '\0';
-                dst = __padstr( dst, buf, 1, width, leftadjust, padchar );
+                dst = _put_field( dst, &room, buf, 1, width,
+                                  leftadjust, padchar );
                 break;
 
             case 'd':
                 len = __cvtdec( buf, *ap++ );
-                dst = __padstr( dst, buf, len, width, leftadjust, padchar );
+                dst = _put_field( dst, &room, buf, len, width,
+                                  leftadjust, padchar );
                 break;
 
             case 's':
                 str = (char *) (*ap++);
-                dst = __padstr( dst, str, -1, width, leftadjust, padchar );
+                dst = _put_field( dst, &room, str, -1, width,
+                                  leftadjust, padchar );
                 break;
 
             case 'x':
-                len = __cvthex( buf, *ap++ ) + 2;
-                dst = __padstr( dst, buf, len, width, leftadjust, padchar );
+                len = __cvthex( buf, *ap++ );
+                dst = _put_field( dst, &room, buf, len, width,
+                                  leftadjust, padchar );
                 break;
 
             case 'o':
                 len = __cvtoct( buf, *ap++ );
-                dst = __padstr( dst, buf, len, width, leftadjust, padchar );
+                dst = _put_field( dst, &room, buf, len, width,
+                                  leftadjust, padchar );
                 break;
 
             }
-        } else {
+        } else if( room > 0 ) {
             // no, it's just an ordinary character
             *dst++ = ch;
+            room -= 1;
         }
     }
 
     // NUL-terminate the result
     *dst = '\0';
+
+    return( dst - start );
+}
+
+/*
+** Name:        __sprint
+**
+** Description: Formatted output into a string buffer
+**
+** @param dst   The destination buffer
+** @param fmt   The format string
+**
+** The format string parameter is followed by zero or more additional
+** parameters which are interpreted according to the format string.
+**
+** NOTE:  assumes the buffer is large enough to hold the result string
+**
+** NOTE:  relies heavily on the x86 convention that parameters
+** are pushed onto the stack in reverse order as 32-bit values.
+*/
+void __sprint( char *dst, char *fmt, ... ) {
+
+    // get the pointer to the first "value" parameter
+    (void) __vsnprint( dst, 0xffffffff, fmt, (int32 *)(&fmt) + 1 );
 }
 
 /*
@@ -483,8 +519,7 @@ int __cvtoct( char *buf, int value ){
 	char	*bp = buf;
 	int	val;
 
-	val = ( value & 0xc0000000 );
-	val >>= 30;
+	val = ( value >> 30 ) & 0x3;
 	for( i = 0; i < 11; i += 1 ){
 
 		if( i == 10 || val != 0 || chars_stored ){
@@ -492,7 +527,8 @@ int __cvtoct( char *buf, int value ){
 			val &= 0x7;
 			*bp++ = __hexdigits[ val ];
 		}
-		value <<= 3;
+		// the first digit holds only the top two bits
+		value <<= ( i == 0 ? 2 : 3 );
 		val = ( value & 0xe0000000 );
 		val >>= 29;
 	}
@@ -513,6 +549,14 @@ int __cvtoct( char *buf, int value ){
 ** if it isn't NULL, followed by a newline
 */
 void _kpanic( char *mod, char *msg ) {
+#if !PANIC_DUMPS_QUEUES
+    uint32 readers, writers;
+#endif
+
+    // make sure the console is what's on the display, and get out
+    // whatever was logged on the way here
+    __cio_show( NULL );
+    _klog_flush();
 
     __cio_puts( "\n\n***** KERNEL PANIC *****\n\n" );
     __cio_printf( "Mod:  %s   Msg: %s\n", mod, msg ? msg : "(none)" );
@@ -524,13 +568,17 @@ void _kpanic( char *mod, char *msg ) {
 #if PANIC_DUMPS_QUEUES
     _queue_dump( "Sleep queue", _sleeping );
     _queue_dump( "Waiting queue", _waiting );
-    _queue_dump( "Reading queue", _reading );
+    _cons_queue_dump();
+    _sio_queue_dump();
     _queue_dump( "Zombie queue", _zombie );
     _queue_dump( "Ready queue", _ready );
 #else
+    _sio_blocked( &readers, &writers );
+    readers += _cons_blocked();
     __cio_printf( "Queue sizes:  sleep %d", _queue_length(_sleeping) );
-    __cio_printf( " wait %d read %d zombie %d", _queue_length(_waiting),
-                  _queue_length(_reading), _queue_length(_zombie) );
+    __cio_printf( " wait %d read %d write %d zombie %d",
+                  _queue_length(_waiting), readers, writers,
+                  _queue_length(_zombie) );
     __cio_printf( " ready %d\n", _queue_length(_ready) );
 #endif
 
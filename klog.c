@@ -0,0 +1,264 @@
+/*
+** SCCS ID:	@(#)klog.c	1.1	3/30/20
+**
+** File:	klog.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Kernel log implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "klog.h"
+#include "kthread.h"
+#include "sio.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+#if (KLOG_RECORDS & (KLOG_RECORDS - 1)) != 0
+#error "KLOG_RECORDS must be a power of two"
+#endif
+
+// the slot holding record number 'n'
+
+#define	SLOT(n)		(&_klog_ring[ (n) & (KLOG_RECORDS - 1) ])
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// one log record
+
+typedef struct klogrec_s {
+    uint32 time;              // system time when recorded
+    uint8 level;              // severity
+    char text[ KLOG_TEXT ];   // the message (NUL-terminated)
+} KlogRec;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+// the ring; records are numbered from 0, and each is kept in the slot
+// for its number until it is overwritten KLOG_RECORDS records later.
+// only modified with interrupts disabled.
+
+static KlogRec _klog_ring[ KLOG_RECORDS ];
+static uint32 _klog_next;      // number of the next record to be written
+static uint32 _klog_drained;   // number of the next record to be drained
+static bool _klog_pending;     // has a drain been deferred?
+
+// records overwritten before they could be drained
+
+static uint32 _klog_dropped;
+
+// level tags for the formatted records
+
+static const char _klog_tags[ N_KLOG_LEVELS ] = { 'E', 'W', 'I', 'D' };
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+uint32 _klog_record = KLOG_ALL;
+uint32 _klog_drain = KLOG_ALL & ~KLOG_MASK(KLOG_DEBUG);
+
+#ifdef KLOG_SIO
+uint32 _klog_sinks = KLOG_TO_CIO | KLOG_TO_SIO;
+#else
+uint32 _klog_sinks = KLOG_TO_CIO;
+#endif
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _klog_oldest() - number of the oldest record still in the ring
+//
+// Must be called with interrupts disabled.
+//
+static uint32 _klog_oldest( void ) {
+
+    return( _klog_next > KLOG_RECORDS ? _klog_next - KLOG_RECORDS : 0 );
+}
+
+//
+// _klog_format() - turn a record into a line of text
+//
+// @param r     The record
+// @param line  Where to put the line (at least KLOG_LINE bytes)
+//
+// @returns The length of the line
+//
+static uint32 _klog_format( KlogRec *r, char *line ) {
+
+    __sprint( line, "[%5d.%03d] %c %s\n", r->time / 1000, r->time % 1000,
+              _klog_tags[ r->level ], r->text );
+
+    return( __strlen(line) );
+}
+
+//
+// _klog_work() - drain the waiting records (deferred work)
+//
+// Each record is formatted with interrupts disabled, so that it can't
+// be overwritten while we look at it, and is then written out with
+// interrupts in whatever state they were in when we were called.
+//
+static void _klog_work( uint32 unused ) {
+    char line[ KLOG_LINE ];
+
+    for(;;) {
+        uint32 len = 0;
+        uint32 flags = __get_flags();
+        __cli();
+
+        if( _klog_drained == _klog_next ) {
+            _klog_pending = false;
+            __set_flags( flags );
+            return;
+        }
+
+        KlogRec *r = SLOT( _klog_drained );
+        ++_klog_drained;
+        if( _klog_drain & KLOG_MASK(r->level) ) {
+            len = _klog_format( r, line );
+        }
+        __set_flags( flags );
+
+        if( len == 0 ) {
+            continue;
+        }
+        if( _klog_sinks & KLOG_TO_CIO ) {
+            __cio_write( line, len );
+        }
+        if( _klog_sinks & KLOG_TO_SIO ) {
+            (void) _sio_write( SIO_COM1, line, len );
+        }
+    }
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _klog() - record a kernel message
+//
+// May be called from any context, including interrupt handlers.
+//
+// @param level   The severity level (KLOG_*)
+// @param fmt     A __sprint() format string, followed by its parameters
+//
+void _klog( uint32 level, char *fmt, ... ) {
+
+    if( level >= N_KLOG_LEVELS || (_klog_record & KLOG_MASK(level)) == 0 ) {
+        return;
+    }
+
+    uint32 flags = __get_flags();
+    __cli();
+
+    KlogRec *r = SLOT( _klog_next );
+    r->time = (uint32) _system_time;
+    r->level = level;
+    (void) __vsnprint( r->text, KLOG_TEXT, fmt, (int32 *)(&fmt) + 1 );
+    ++_klog_next;
+
+    // if the drain has fallen a whole ring behind, the record it
+    // would have done next has just been overwritten
+    if( _klog_next - _klog_drained > KLOG_RECORDS ) {
+        ++_klog_drained;
+        ++_klog_dropped;
+    }
+
+    if( !_klog_pending ) {
+        _klog_pending = true;
+        _kthread_defer( _klog_work, 0 );
+    }
+
+    __set_flags( flags );
+}
+
+//
+// _klog_read() - copy formatted records into a buffer
+//
+// Copies whole lines, beginning with record number '*seq' (or the
+// oldest record still in the ring, if that one has been overwritten).
+//
+// @param seq     The first record wanted; updated to the next record
+// @param buf     Where to put the lines
+// @param length  The size of 'buf'
+//
+// @returns The number of bytes copied
+//
+uint32 _klog_read( uint32 *seq, char *buf, uint32 length ) {
+    char line[ KLOG_LINE ];
+    uint32 s = *seq;
+    uint32 n = 0;
+
+    for(;;) {
+        uint32 flags = __get_flags();
+        __cli();
+
+        // start over at the oldest record if 's' is outside the ring
+        uint32 oldest = _klog_oldest();
+        if( s - oldest > _klog_next - oldest ) {
+            s = oldest;
+        }
+
+        if( s == _klog_next ) {
+            __set_flags( flags );
+            break;
+        }
+
+        uint32 len = _klog_format( SLOT(s), line );
+        __set_flags( flags );
+
+        if( n + len > length ) {
+            break;
+        }
+        __memcpy( buf + n, line, len );
+        n += len;
+        ++s;
+    }
+
+    *seq = s;
+    return( n );
+}
+
+//
+// _klog_flush() - drain the waiting records immediately
+//
+// For use when the worker thread will not get to run (e.g., before
+// a panic).
+//
+void _klog_flush( void ) {
+
+    _klog_work( 0 );
+}
+
+//
+// _klog_dump() - print all the records in the ring on the console
+//
+void _klog_dump( void ) {
+    char line[ KLOG_LINE ];
+    uint32 seq = 0;
+    uint32 n;
+
+    __cio_printf( "\nKernel log: %d records, %d dropped,"
+                  " recording %x, draining %x\n",
+                  _klog_next, _klog_dropped, _klog_record, _klog_drain );
+
+    while( (n = _klog_read( &seq, line, sizeof(line) )) > 0 ) {
+        __cio_write( line, n );
+    }
+}
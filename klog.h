@@ -0,0 +1,127 @@
+/*
+** SCCS ID:	@(#)klog.h	1.1	3/30/20
+**
+** File:	klog.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Kernel log declarations
+**
+** Kernel diagnostics are recorded with _klog() in a fixed-size ring
+** of timestamped records, each with a severity level.  Recording a
+** message only formats it into the ring, so it is cheap enough to do
+** from an interrupt handler; the records are copied to the console
+** (and, optionally, to COM1) later by the kernel worker thread.  If
+** the ring fills before the records can be drained, the oldest ones
+** are overwritten and counted as dropped.  User processes can read
+** the ring with the klog() system call.
+*/
+
+#ifndef _KLOG_H_
+#define _KLOG_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+// number of records in the ring (must be a power of two), and the
+// longest message a record can hold
+
+#define	KLOG_RECORDS	128
+#define	KLOG_TEXT	116
+
+// severity levels
+
+#define	KLOG_ERR	0
+#define	KLOG_WARN	1
+#define	KLOG_INFO	2
+#define	KLOG_DEBUG	3
+
+#define	N_KLOG_LEVELS	4
+
+// bit for a level in the level masks
+
+#define	KLOG_MASK(l)	(1 << (l))
+#define	KLOG_ALL	(KLOG_MASK(N_KLOG_LEVELS) - 1)
+
+// where drained records go
+
+#define	KLOG_TO_CIO	0x01
+#define	KLOG_TO_SIO	0x02
+
+// longest line produced for a record (timestamp, level, text, newline)
+
+#define	KLOG_LINE	(KLOG_TEXT + 20)
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Types
+*/
+
+/*
+** Globals
+*/
+
+// levels which are recorded, and those which are also drained to the
+// console and/or serial port; may be changed at any time
+
+extern uint32 _klog_record;
+extern uint32 _klog_drain;
+
+// destinations for drained records (KLOG_TO_* bits)
+
+extern uint32 _klog_sinks;
+
+/*
+** Prototypes
+*/
+
+//
+// _klog() - record a kernel message
+//
+// May be called from any context, including interrupt handlers.
+//
+// @param level   The severity level (KLOG_*)
+// @param fmt     A __sprint() format string, followed by its parameters
+//
+void _klog( uint32 level, char *fmt, ... );
+
+//
+// _klog_read() - copy formatted records into a buffer
+//
+// Copies whole lines, beginning with record number '*seq' (or the
+// oldest record still in the ring, if that one has been overwritten).
+//
+// @param seq     The first record wanted; updated to the next record
+// @param buf     Where to put the lines
+// @param length  The size of 'buf'
+//
+// @returns The number of bytes copied
+//
+uint32 _klog_read( uint32 *seq, char *buf, uint32 length );
+
+//
+// _klog_flush() - drain the waiting records immediately
+//
+// For use when the worker thread will not get to run (e.g., before
+// a panic).
+//
+void _klog_flush( void );
+
+//
+// _klog_dump() - print all the records in the ring on the console
+//
+void _klog_dump( void );
+
+#endif
+
+#endif
@@ -583,7 +583,7 @@ void _kfree_page( void *block ){
 /*
 ** Slices are 1024-byte fragments from pages.  We maintain a free list of
 ** slices for those parts of the OS which don't need full 4096-byte chunks
-** of space (e.g., the QNode and Queue allocators).
+** of space (e.g., the Queue and PCB allocators).
 */
 
 /*
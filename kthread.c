@@ -0,0 +1,237 @@
+/*
+** SCCS ID:	@(#)kthread.c	1.1	3/30/20
+**
+** File:	kthread.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Kernel threads and deferred work implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "kthread.h"
+#include "scheduler.h"
+#include "stacks.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// an entry in the deferred work queue
+
+typedef struct work_s {
+    Workfcn fcn;
+    uint32 arg;
+} Work;
+
+/*
+** PRIVATE GLOBAL VARIABLES
+*/
+
+// the deferred work queue; only modified with interrupts disabled
+
+static Work _work[ KT_WORK_SIZE ];
+static uint32 _work_head;   // next entry to be done
+static uint32 _work_tail;   // next free entry
+
+// the worker thread, and whether it is waiting for work
+
+static Pcb *_worker;
+static bool _parked;
+
+// statistics
+
+static uint32 _work_queued;    // entries queued
+static uint32 _work_done;      // entries done by the worker
+static uint32 _work_inline;    // entries done at once (queue was full)
+static uint32 _work_maxdepth;  // high-water mark for the queue
+
+/*
+** PUBLIC GLOBAL VARIABLES
+*/
+
+Queue _kready;
+
+/*
+** PRIVATE FUNCTIONS
+*/
+
+//
+// _kthread_park() - ISR for INT_VEC_KTHREAD
+//
+// A kernel thread which has run out of work gives up the CPU here.
+// The check for more work is repeated now that interrupts are off,
+// so work deferred after the thread last looked is not missed.
+//
+// Any other kernel thread is simply moved to the back of the ready
+// queue, as there is nothing for it to wait for.
+//
+static void _kthread_park( int vector, int code ) {
+
+    if( _current != _worker ) {
+        _schedule( _current );
+    } else if( _work_head != _work_tail ) {
+        // more work arrived; keep going
+        return;
+    } else {
+        _parked = true;
+        _current->state = BLOCKED;
+        _current->queue = NULL;
+    }
+
+    _dispatch();
+}
+
+//
+// _kworker() - the worker thread
+//
+// Carries out deferred work, one entry at a time.  Each entry is
+// removed from the queue with interrupts disabled, but is done with
+// interrupts enabled.
+//
+static int _kworker( int argc, char *args ) {
+    Work w;
+
+    for(;;) {
+        uint32 flags = __get_flags();
+        __cli();
+        bool found = _work_head != _work_tail;
+        if( found ) {
+            w = _work[ _work_head % KT_WORK_SIZE ];
+            ++_work_head;
+        }
+        __set_flags( flags );
+
+        if( found ) {
+            w.fcn( w.arg );
+            ++_work_done;
+        } else {
+            __asm__ __volatile__( "int %0" : : "i" (INT_VEC_KTHREAD) );
+        }
+    }
+
+    return( 0 );  // shut the compiler up!
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// _kthread_init() - initialize the kernel thread module
+//
+void _kthread_init( void ) {
+
+    _kready = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    assert( _kready );
+
+    _worker = NULL;
+    _work_head = _work_tail = 0;
+    _work_queued = _work_done = _work_inline = _work_maxdepth = 0;
+
+    __install_isr( INT_VEC_KTHREAD, _kthread_park );
+
+    // start the worker; it parks itself when it finds nothing to do
+    _parked = false;
+    int pid = _kthread_create( _kworker, "kworker" );
+    assert( pid > 0 );
+    _worker = _pcb_find( pid );
+}
+
+//
+// _kthread_create() - create a kernel thread
+//
+// @param entry  The function the thread will execute; must never return
+// @param name   Name of the thread (passed as its argv[0])
+//
+// @returns The PID of the thread, or an error code
+//
+int _kthread_create( int (*entry)(int,char *), char *name ) {
+    char *argv[2] = { name, NULL };
+
+    Pcb *pcb = _pcb_alloc();
+    if( pcb == NULL ) {
+        return( E_MAX_PROCS );
+    }
+
+    Stack *stk = _stk_alloc();
+    if( stk == NULL ) {
+        _pcb_free( pcb );
+        return( E_NO_MEMORY );
+    }
+
+    // no parent, so this is a kernel thread
+    int pid = _proc_create( pcb, stk, NULL, (uint32) entry, argv );
+    if( pid <= 0 ) {
+        _pcb_free( pcb );
+        _stk_free( stk );
+        return( pid );
+    }
+
+    _active += 1;
+    _schedule( pcb );
+
+    return( pid );
+}
+
+//
+// _kthread_defer() - queue work for the worker thread
+//
+// @param fcn   The function to be called
+// @param arg   Its argument
+//
+void _kthread_defer( Workfcn fcn, uint32 arg ) {
+
+    // if there's no room, or no worker yet, do it now
+    if( _worker == NULL || _work_tail - _work_head >= KT_WORK_SIZE ) {
+        ++_work_inline;
+        fcn( arg );
+        return;
+    }
+
+    _work[ _work_tail % KT_WORK_SIZE ].fcn = fcn;
+    _work[ _work_tail % KT_WORK_SIZE ].arg = arg;
+    ++_work_tail;
+    ++_work_queued;
+
+    if( _work_tail - _work_head > _work_maxdepth ) {
+        _work_maxdepth = _work_tail - _work_head;
+    }
+
+    // wake the worker if it's waiting
+    if( _parked ) {
+        _parked = false;
+        _worker->state = READY;
+        _worker->queue = _kready;
+        _queue_enque( _kready, (void *) _worker );
+    }
+}
+
+//
+// _kthread_preempt() - let a waiting kernel thread run now
+//
+void _kthread_preempt( void ) {
+
+    if( _queue_length(_kready) > 0 && !IS_KTHREAD(_current) ) {
+        _preempt();
+    }
+}
+
+//
+// _kthread_dump() - print deferred work statistics
+//
+void _kthread_dump( void ) {
+
+    __cio_printf( "deferred work: queued %d done %d inline %d max depth %d"
+                  " pending %d\n", _work_queued, _work_done, _work_inline,
+                  _work_maxdepth, _work_tail - _work_head );
+}
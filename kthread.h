@@ -0,0 +1,119 @@
+/*
+** SCCS ID:	@(#)kthread.h	1.1	3/30/20
+**
+** File:	kthread.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Kernel threads and deferred work declarations
+**
+** A kernel thread is a process whose code is part of the kernel.  It
+** runs on its own stack, with interrupts enabled, and is scheduled
+** like any other process; it has no parent (its PPID is 0), never
+** exits, and cannot be killed.
+**
+** Interrupt handlers should do only the work that must be done with
+** interrupts disabled, and hand the rest to _kthread_defer().  Deferred
+** work is carried out by the kernel worker thread, which is dispatched
+** ahead of all other ready processes.  Work functions run with
+** interrupts ENABLED; any that manipulate queues or PCBs must disable
+** interrupts around those operations themselves.
+*/
+
+#ifndef _KTHREAD_H_
+#define _KTHREAD_H_
+
+#include "common.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+// vector used by kernel threads to give up the CPU
+
+#define	INT_VEC_KTHREAD		0x43
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+#include "process.h"
+#include "queues.h"
+
+// number of entries in the deferred work queue
+
+#define	KT_WORK_SIZE	64
+
+// is this PCB a kernel thread?
+
+#define	IS_KTHREAD(pcb)	((pcb)->ppid == 0)
+
+/*
+** Types
+*/
+
+// a deferred work function and its argument
+
+typedef void (*Workfcn)( uint32 );
+
+/*
+** Globals
+*/
+
+// kernel threads with deferred work to do (dispatched first)
+extern Queue _kready;
+
+/*
+** Prototypes
+*/
+
+//
+// _kthread_init() - initialize the kernel thread module
+//
+// Must be called after the queue, process, scheduler and stack
+// modules have been initialized.  Creates the worker thread.
+//
+void _kthread_init( void );
+
+//
+// _kthread_create() - create a kernel thread
+//
+// @param entry  The function the thread will execute; must never return
+// @param name   Name of the thread (passed as its argv[0])
+//
+// @returns The PID of the thread, or an error code
+//
+int _kthread_create( int (*entry)(int,char *), char *name );
+
+//
+// _kthread_defer() - queue work for the worker thread
+//
+// Must be called with interrupts disabled.  If the queue is full,
+// the work is done immediately instead.
+//
+// @param fcn   The function to be called
+// @param arg   Its argument
+//
+void _kthread_defer( Workfcn fcn, uint32 arg );
+
+//
+// _kthread_preempt() - let a waiting kernel thread run now
+//
+// Called at the end of an interrupt handler which has deferred work.
+// If a kernel thread is ready, the current process is preempted in
+// its favor.
+//
+void _kthread_preempt( void );
+
+//
+// _kthread_dump() - print deferred work statistics
+//
+void _kthread_dump( void );
+
+#endif
+
+#endif
@@ -14,11 +14,22 @@
 
 #include "common.h"
 #include "process.h"
+#include "kmem.h"
+#include "scheduler.h"
+#include "fpu.h"
 
 /*
 ** PRIVATE DEFINITIONS
 */
 
+// number of PCBs carved from each page added to the PCB cache
+
+#define PCBS_PER_PAGE   (PAGE_SIZE / sizeof(Pcb))
+
+// size of the kernel stack owned by each PCB
+
+#define KSTACK_SIZE     PAGE_SIZE
+
 /*
 ** PRIVATE DATA TYPES
 */
@@ -28,16 +39,106 @@
 */
 
 // PCB management
-static Pcb *_free_pcbs;
+static Pcb *_free_pcbs;     // cache of unused PCBs
+static Pcb *_all_pcbs;      // all allocated PCBs
+static uint32 _pcb_count;   // number of allocated PCBs
+
+// PID allocation bitmap; bit n is set when PID n is in use
+static uint32 _pid_map[ PID_MAX / 32 ];
+
+// PID hash table; chains are linked through the 'hash_next' field
+static Pcb *_pid_hash[ PID_HASH_SIZE ];
 
 /*
 ** PUBLIC GLOBAL VARIABLES
 */
 
+// limit on the number of PCBs which may be allocated at once
+uint32 _proc_limit;
+
 /*
 ** PRIVATE FUNCTIONS
 */
 
+//
+// _pcb_grow() - add a page worth of PCBs to the free pool
+//
+// @returns true on success, else false
+//
+static bool _pcb_grow( void ) {
+    Pcb *block = (Pcb *) _kalloc_page( 1 );
+
+    if( block == NULL ) {
+        return( false );
+    }
+
+    __memclr( block, PAGE_SIZE );
+
+    for( uint32 i = 0; i < PCBS_PER_PAGE; ++i ) {
+        block[i].state = UNUSED;
+        block[i].queue = (Queue) _free_pcbs;
+        _free_pcbs = &block[i];
+    }
+
+    return( true );
+}
+
+//
+// _pid_alloc() - allocate an unused PID
+//
+// Hands out PIDs in increasing order, wrapping around (and skipping
+// those still in use) when the PID space is exhausted.
+//
+// @returns The PID, or 0 if none are available
+//
+static Pid _pid_alloc( void ) {
+
+    for( uint32 n = 0; n < PID_MAX; ++n ) {
+        Pid pid = _next_pid++;
+        uint32 bit = 1u << (pid & 31);
+
+        if( pid != 0 && (_pid_map[pid >> 5] & bit) == 0 ) {
+            _pid_map[pid >> 5] |= bit;
+            return( pid );
+        }
+    }
+
+    return( 0 );
+}
+
+//
+// _pid_free() - release a PID for reuse
+//
+static void _pid_free( Pid pid ) {
+    _pid_map[pid >> 5] &= ~(1u << (pid & 31));
+}
+
+//
+// _pid_hash_add() - add a PCB to the PID hash table
+//
+static void _pid_hash_add( Pcb *pcb ) {
+    Pcb **bucket = &_pid_hash[ pcb->pid & (PID_HASH_SIZE - 1) ];
+
+    pcb->hash_next = *bucket;
+    *bucket = pcb;
+}
+
+//
+// _pid_hash_remove() - remove a PCB from the PID hash table
+//
+static void _pid_hash_remove( Pcb *pcb ) {
+    Pcb **link = &_pid_hash[ pcb->pid & (PID_HASH_SIZE - 1) ];
+
+    while( *link != NULL ) {
+        if( *link == pcb ) {
+            *link = pcb->hash_next;
+            pcb->hash_next = NULL;
+            return;
+        }
+        link = &(*link)->hash_next;
+    }
+}
+
 /*
 ** PUBLIC FUNCTIONS
 */
@@ -52,16 +153,44 @@ static Pcb *_free_pcbs;
 Pcb *_pcb_alloc( void ) {
     Pcb *new;
 
+    // enforce the process limit
+    if( _pcb_count >= _proc_limit ) {
+        return( NULL );
+    }
+
+    // if the pool is empty, try to refill it
+    if( _free_pcbs == NULL && !_pcb_grow() ) {
+        return( NULL );
+    }
+
     // just take the first one from the list
     new = _free_pcbs;
 
-    // assuming we got one, unlink it and initialize it
-    if( new != NULL ) {
-        _free_pcbs = (Pcb *) (new->queue);
-        new->queue = NULL;
-        new->state = NEW;
+    // a PCB keeps its kernel stack when it is freed, so it only
+    // needs one the first time it is used
+    if( new->kesp == NULL ) {
+        uint32 *kstack = (uint32 *) _kalloc_page( KSTACK_SIZE / PAGE_SIZE );
+        if( kstack == NULL ) {
+            return( NULL );
+        }
+        // leave room for two uint32s at the top, as for _system_esp
+        new->kesp = kstack + (KSTACK_SIZE / sizeof(uint32)) - 2;
     }
 
+    // unlink it and initialize it
+    _free_pcbs = (Pcb *) (new->queue);
+    new->queue = NULL;
+    new->state = NEW;
+
+    // add it to the list of allocated PCBs
+    new->all_prev = NULL;
+    new->all_next = _all_pcbs;
+    if( _all_pcbs != NULL ) {
+        _all_pcbs->all_prev = new;
+    }
+    _all_pcbs = new;
+    _pcb_count += 1;
+
     return( new );
 }
 
@@ -72,6 +201,20 @@ void _pcb_free( Pcb *pcb ) {
 
     // make sure we were given one to release
     if( pcb != NULL ) {
+        // remove it from the list of allocated PCBs
+        if( pcb->all_prev != NULL ) {
+            pcb->all_prev->all_next = pcb->all_next;
+        } else {
+            _all_pcbs = pcb->all_next;
+        }
+        if( pcb->all_next != NULL ) {
+            pcb->all_next->all_prev = pcb->all_prev;
+        }
+        _pcb_count -= 1;
+        // its FPU state is no longer needed
+        _fpu_release( pcb );
+        // it must not still be on a queue
+        assert2( pcb->qlink.next == NULL );
         // mark it as available
         pcb->state = UNUSED;
         // add it to the front of the free list
@@ -85,17 +228,78 @@ void _pcb_free( Pcb *pcb ) {
 //
 Pcb *_pcb_find( Pid pid ) {
 
-    // iterate through the PCB table
-    for( int i = 0; i < N_PROCS; ++i ) {
+    // search the appropriate hash chain
+    Pcb *pcb = _pid_hash[ pid & (PID_HASH_SIZE - 1) ];
+
+    while( pcb != NULL ) {
         // if this is the one we want, we're done
-        if( _pcbs[i].pid == pid && _pcbs[i].state != UNUSED ) {
-            return( &_pcbs[i] );
+        if( pcb->pid == pid && pcb->state != UNUSED ) {
+            return( pcb );
         }
+        pcb = pcb->hash_next;
     }
 
     return( NULL );
 }
 
+//
+// _pcb_first() - begin an iteration over all allocated PCBs
+//
+// @returns The first allocated PCB, or NULL
+//
+Pcb *_pcb_first( void ) {
+    return( _all_pcbs );
+}
+
+//
+// _pcb_next() - continue an iteration over all allocated PCBs
+//
+// @param pcb   The PCB returned by the previous call
+//
+// @returns The next allocated PCB, or NULL
+//
+Pcb *_pcb_next( Pcb *pcb ) {
+    return( pcb->all_next );
+}
+
+//
+// _pcb_list_add() - add a PCB to the front of a child list
+//
+// @param list  The 'kids' or 'zombies' list of the parent
+// @param pcb   The child to add
+//
+void _pcb_list_add( Pcb **list, Pcb *pcb ) {
+
+    pcb->sib_prev = NULL;
+    pcb->sib_next = *list;
+    if( *list != NULL ) {
+        (*list)->sib_prev = pcb;
+    }
+    *list = pcb;
+}
+
+//
+// _pcb_list_remove() - remove a PCB from a child list
+//
+// @param list  The 'kids' or 'zombies' list containing the PCB
+// @param pcb   The child to remove
+//
+void _pcb_list_remove( Pcb **list, Pcb *pcb ) {
+
+    if( pcb->sib_prev != NULL ) {
+        pcb->sib_prev->sib_next = pcb->sib_next;
+    } else {
+        assert1( *list == pcb );
+        *list = pcb->sib_next;
+    }
+
+    if( pcb->sib_next != NULL ) {
+        pcb->sib_next->sib_prev = pcb->sib_prev;
+    }
+
+    pcb->sib_next = pcb->sib_prev = NULL;
+}
+
 /*
 ** Process management/control
 */
@@ -127,14 +331,20 @@ int _wakeup_cmp( const void *a, const void *b ) {
 void _proc_init( void ) {
 
     _free_pcbs = NULL;
+    _all_pcbs = NULL;
+    _pcb_count = 0;
+    _proc_limit = N_PROCS;
     _active = 0;
 
+    for( int i = 0; i < PID_HASH_SIZE; ++i ) {
+        _pid_hash[i] = NULL;
+    }
+
+    __memclr( _pid_map, sizeof(_pid_map) );
+
     _next_pid = 1;  // PID of init()
 
-    // add each PCB to the free pool
-    for( int i = 0; i < N_PROCS; ++i ) {
-        _pcb_free( &_pcbs[i] );
-    }
+    // PCBs are added to the free pool on demand
 
     // report that we're done
     __cio_puts( " PROCS" );
@@ -155,7 +365,8 @@ int _proc_create( Pcb *pcb, Stack *stk, Pcb *parent,
     // sanity checking!
     assert1( pcb != NULL );
     assert1( stk != NULL );
-    assert1( parent != NULL );
+
+    // a NULL parent is allowed; it makes this a kernel thread
 
     /*
     ** Set up the initial stack contents for a (new) user process.
@@ -210,20 +421,41 @@ int _proc_create( Pcb *pcb, Stack *stk, Pcb *parent,
 
     // OK so far - start filling in the process information
 
+    pcb->pid = _pid_alloc();
+    if( pcb->pid == 0 ) {
+        return( E_MAX_PROCS );
+    }
+
     pcb->stack = stk;
-    pcb->pid = _next_pid++;
 
     // this works even for the init process, because 'pcb' and
     // 'parent' point to the same PCB, and we just filled in
     // the PID for the process :-)
-    pcb->ppid = parent->pid;
+    //
+    // kernel threads have no parent
+    pcb->ppid = parent != NULL ? parent->pid : 0;
 
     pcb->wakeup = 0LL;
     pcb->children = 0;
     pcb->exit_status = 0;
-
-    // increment the parent's child count
-    parent->children += 1;
+    pcb->ring = NULL;
+    pcb->screen = NULL;
+    pcb->kids = NULL;
+    pcb->zombies = NULL;
+    pcb->sib_next = pcb->sib_prev = NULL;
+
+    // make it findable by PID
+    _pid_hash_add( pcb );
+
+    // increment the parent's child count, and add this process
+    // to its list of children (unless this is init, which is
+    // its own parent)
+    if( parent != NULL ) {
+        parent->children += 1;
+        if( parent != pcb ) {
+            _pcb_list_add( &parent->kids, pcb );
+        }
+    }
 
     /*
     ** Align the stack.  The SysV ABI i386 supplement, version 1.2
@@ -282,6 +514,7 @@ int _proc_create( Pcb *pcb, Stack *stk, Pcb *parent,
         while( (*ptr++ = *curr++) ) {    // zoom zoom!
             ;
         }
+        _preempt_point();
     }
 
     // copy in the dummy return address
@@ -319,6 +552,9 @@ int _proc_create( Pcb *pcb, Stack *stk, Pcb *parent,
 void _proc_cleanup( Pcb *pcb ) {
     
     if( pcb != NULL ) {
+        // it can no longer be found by PID, and its PID can be reused
+        _pid_hash_remove( pcb );
+        _pid_free( pcb->pid );
         // eliminate the stack, if there is one
         if( pcb->stack != NULL ) {
             _stk_free( pcb->stack );
@@ -398,13 +634,10 @@ void _context_dump_all( const char *msg ) {
     }
 
     int n = 0;
-    for( int i = 0; i < N_PROCS; ++i ) {
-        Pcb *pcb = &_pcbs[i];
-        if( pcb->state != UNUSED ) {
-            ++n;
-            __cio_printf( "%2d[%2d]: ", n, i );
-            _context_dump( NULL, pcb->context );
-        }
+    for( Pcb *pcb = _pcb_first(); pcb != NULL; pcb = _pcb_next(pcb) ) {
+        ++n;
+        __cio_printf( "%2d[%5d]: ", n, pcb->pid );
+        _context_dump( NULL, pcb->context );
     }
 }
 
@@ -419,35 +652,25 @@ void _active_dump( const char *msg, bool all ) {
         __cio_printf( "%s: ", msg );
     }
 
-    int used = 0;
-    int empty = 0;
-
-    for( int i = 0; i < N_PROCS; ++i ) {
-        register Pcb *pcb = &_pcbs[i];
-        if( pcb->state == UNUSED ) {
+    uint32 used = 0;
 
-            // an empty slot
-            ++empty;
+    for( Pcb *pcb = _pcb_first(); pcb != NULL; pcb = _pcb_next(pcb) ) {
 
-        } else {
-
-            // a non-empty slot
-            ++used;
+        // if not dumping everything, add commas if needed
+        if( !all && used ) {
+            __cio_putchar( ',' );
+        }
 
-            // if not dumping everything, add commas if needed
-            if( !all && used ) {
-                __cio_putchar( ',' );
-            }
+        ++used;
 
-            // things that are always printed
-            __cio_printf( " #%d: %d/%d %d", i, pcb->pid, pcb->ppid,
-                          pcb->state );
+        // things that are always printed
+        __cio_printf( " #%d: %d/%d %d", used, pcb->pid, pcb->ppid,
+                      pcb->state );
 
-            // do we want more info?
-            if( all ) {
-                __cio_printf( " stk %08x EIP %08x\n",
-                      (uint32)pcb->stack, pcb->context->eip );
-            }
+        // do we want more info?
+        if( all ) {
+            __cio_printf( " stk %08x EIP %08x\n",
+                  (uint32)pcb->stack, pcb->context->eip );
         }
     }
 
@@ -456,9 +679,9 @@ void _active_dump( const char *msg, bool all ) {
         __cio_putchar( '\n' );
     }
 
-    // sanity check - make sure we saw the correct number of table slots
-    if( (used + empty) != N_PROCS ) {
-        __cio_printf( "Table size %d, used %d + empty %d = %d???\n",
-                      N_PROCS, used, empty, used + empty );
+    // sanity check - make sure we saw all the allocated PCBs
+    if( used != _pcb_count ) {
+        __cio_printf( "Allocated %d, but found %d???\n",
+                      _pcb_count, used );
     }
 }
@@ -38,17 +38,25 @@
 
 #define RET(pcb)    ((pcb)->context->eax)
 
-// ARG(pcb,n) -- access argument #n from the indicated process
+// ARG(pcb,n) -- access system call argument #n from the indicated process
 //
-// ARG(pcb,0) --> return address
-// ARG(pcb,1) --> first parameter
-// ARG(pcb,2) --> second parameter
-// etc.
+// ARG(pcb,1) --> first parameter (EBX)
+// ARG(pcb,2) --> second parameter (EDX)
+// ARG(pcb,3) --> third parameter (ECX)
 //
-// ASSUMES THE STANDARD 32-BIT ABI, WITH PARAMETERS PUSHED ONTO THE
-// STACK.  IF THE PARAMETER PASSING MECHANISM CHANGES, SO MUST THIS!
+// ASSUMES THE SYSTEM CALL STUBS IN ulibs.S PASS THE PARAMETERS IN
+// REGISTERS, IN THE ORDER THEY APPEAR IN THE CONTEXT.  IF THE PARAMETER
+// PASSING MECHANISM CHANGES, SO MUST THIS!
 
-#define ARG(pcb,n)  ( ( (uint32 *) (((pcb)->context) + 1) ) [(n)] )
+#define ARG(pcb,n)  ( ( &((pcb)->context->ebx) ) [(n)-1] )
+
+// number of buckets in the PID hash table (must be a power of 2)
+
+#define PID_HASH_SIZE   256
+
+// size of the PID space; PID 0 is never assigned
+
+#define PID_MAX         65536
 
 /*
 ** Types
@@ -87,7 +95,7 @@ typedef struct context {
 //
 // ideally, its size should divide evenly into 1024 bytes
 //
-// currently, 32 bytes
+// currently, 88 bytes
 
 typedef struct pcb_s {
     // Start with these eight bytes, for easy access in assembly
@@ -98,11 +106,30 @@ typedef struct pcb_s {
     Time wakeup;            // wakeup time for sleeping process
 
     // four-byte values
+    uint32 *kesp;           // initial ESP for its kernel stack
+                            // (offset 16; see isr_stubs.S)
+
     Queue queue;            // pointer to whatever queue it's on
                             // (doubles as the "free PCB list" link)
+    QLink qlink;            // links within that queue
 
     int32 exit_status;      // termination status
 
+    SysRing *ring;          // registered system call ring, or NULL
+
+    uint16 *screen;         // screen from conmap(), or NULL
+
+    struct fpuarea_s *fpu;  // FPU/SSE save area, or NULL if the
+                            // process has never used the FPU
+
+    struct pcb_s *hash_next;    // next PCB in this PID hash chain
+    struct pcb_s *kids;         // live children of this process
+    struct pcb_s *zombies;      // terminated children not yet reaped
+    struct pcb_s *sib_next;     // links in the parent's 'kids' or
+    struct pcb_s *sib_prev;     //   'zombies' list
+    struct pcb_s *all_next;     // links in the list of all allocated
+    struct pcb_s *all_prev;     //   PCBs (see _pcb_first())
+
     // two-byte values
     Pid pid;                // unique PID for this process
     Pid ppid;               // PID of the parent
@@ -117,6 +144,9 @@ typedef struct pcb_s {
 ** Globals
 */
 
+// limit on the number of PCBs which may be allocated at once
+extern uint32 _proc_limit;
+
 /*
 ** Prototypes
 */
@@ -140,6 +170,41 @@ void _pcb_free( Pcb *pcb );
 //
 Pcb *_pcb_find( Pid pid );
 
+//
+// _pcb_first() - begin an iteration over all allocated PCBs
+//
+// usage:
+//      for( Pcb *pcb = _pcb_first(); pcb != NULL; pcb = _pcb_next(pcb) )
+//
+// @returns The first allocated PCB, or NULL
+//
+Pcb *_pcb_first( void );
+
+//
+// _pcb_next() - continue an iteration over all allocated PCBs
+//
+// @param pcb   The PCB returned by the previous call
+//
+// @returns The next allocated PCB, or NULL
+//
+Pcb *_pcb_next( Pcb *pcb );
+
+//
+// _pcb_list_add() - add a PCB to the front of a child list
+//
+// @param list  The 'kids' or 'zombies' list of the parent
+// @param pcb   The child to add
+//
+void _pcb_list_add( Pcb **list, Pcb *pcb );
+
+//
+// _pcb_list_remove() - remove a PCB from a child list
+//
+// @param list  The 'kids' or 'zombies' list containing the PCB
+// @param pcb   The child to remove
+//
+void _pcb_list_remove( Pcb **list, Pcb *pcb );
+
 /*
 ** Process management/control
 */
@@ -162,6 +227,8 @@ void _proc_init( void );
 //
 // _proc_create() - create a process from supplied data
 //
+// a NULL parent creates a kernel thread (see kthread.h)
+//
 // returns the PID of the process, or an error code
 //
 int _proc_create( Pcb *pcb, Stack *stk, Pcb *parent,
@@ -20,6 +20,12 @@
 ** PRIVATE DEFINITIONS
 */
 
+// how a Queue is organized
+
+#define Q_FIFO      0   // circular list, insertion at the end
+#define Q_SORTED    1   // circular list, kept in order
+#define Q_HEAP      2   // pairing heap
+
 /*
 ** PRIVATE DATA TYPES
 */
@@ -27,43 +33,58 @@
 /*
 ** Queue organization
 ** ------------------
-** Our queues are self-ordering, generic queues.  A Queue can contain
-** any type of data.  This is accomplished through the use of intermediate
-** nodes called QNodes, which contain a void* data member, allowing them
-** to point to any type of integral data (integers, pointers, etc.).
-** 
+** Our queues are self-ordering, generic, intrusive queues.  Anything
+** placed on a Queue must contain a QLink; the Queue remembers where
+** that QLink is within the object (its 'offset'), and converts between
+** object pointers and QLink pointers as needed.  Because the links
+** live in the objects themselves, adding something to a Queue never
+** allocates memory and never fails.
+**
 ** Each Queue has associated with it a comparison function, which may be
-** NULL.  Insertions into a Queue are handled according to this function.
-** If the function pointer is NULL, the queue is FIFO, and the insertion
-** is always done at the end of the queue.  Otherwise, the insertion is
-** ordered according to the results from the comparison function.
+** NULL.  If the function pointer is NULL, the queue is FIFO, and the
+** insertion is always done at the end of the queue.  Otherwise, the
+** queue is ordered according to the results from the comparison
+** function.
+**
+** FIFO (and sorted) queues are circular doubly-linked lists through
+** a sentinel QLink in the Queue itself, so there are no special cases
+** for the ends of the list, and any member can be unlinked in constant
+** time.
+**
+** Ordered queues are pairing heaps.  The root is head.next, and has
+** head as its 'prev'.  Every other entry is linked into the list of
+** its parent's children:  'child' is its own first child, 'next' is
+** its next sibling (NULL for the last one), and 'prev' is its previous
+** sibling or, for a first child, its parent.  Insertion is constant
+** time, and removal of the first entry (or any other) is O(log n)
+** amortized; the first entry is always at the root.
+**
+** A QLink which is not on any queue has NULL next, prev and child
+** pointers.
 */
 
-// queue nodes
-typedef struct qnode_s {
-    void *data;         // what's in this entry
-    struct qnode_s *next;   // link to next queue entry
-} QNode;
-
 // the Queue itself
 //
 // the Queue type is defined in the header file, as "Queue" must be visible
 // to the outside world; however, the Queue contents are not visible
 struct queue_s {
-    QNode *head;        // first element
-    QNode *tail;        // last element
+    QLink head;         // sentinel (lists), or root holder (heaps)
     int (*cmp)( const void *, const void * );   // how to compare entries
     uint32 length;      // current occupancy count
+    uint32 offset;      // location of the QLink within each entry
+    uint32 kind;        // Q_FIFO, Q_SORTED or Q_HEAP
 };
 
+// conversions between entries and their links
+
+#define LINK(q,data)    ((QLink *) (((uint8 *) (data)) + (q)->offset))
+#define DATA(q,link)    ((void *) (((uint8 *) (link)) - (q)->offset))
+
 /*
 ** PRIVATE GLOBAL VARIABLES
 */
 
-// the list of free qnodes
-static QNode *_free_qnodes;
-
-// the list of free queue structures
+// the list of free queue structures, linked through head.next
 // (same as Queue, but defined this way for clarity)
 static struct queue_s *_free_queues;
 
@@ -75,130 +96,329 @@ static struct queue_s *_free_queues;
 ** PRIVATE FUNCTIONS
 */
 
-// forward declaration
-static bool _qnode_setup( bool critical );
+//
+// _queue_setup() - allocate a slice of memory and turn it into Queues
+//
+// Parameters:
+//    critical   - true if this is a critical allocation, else false
+//
+// Returns:
+//    true on success, else false
+//
+// If this is a critical allocation, we panic on allocation failure;
+// otherwise, we simply return "false" to indicate the failure.
+//
+static bool _queue_setup( bool critical ) {
+    struct queue_s *block;
+
+    block = (struct queue_s *) _kalloc_slice();
+
+    // if this is a critical allocation and block is NULL, we're done for
+    assert( !critical || block );
+
+    // whew - not critical; NULL block is still a problem, though
+    if( block == NULL ) {
+        return( false );
+    }
+
+    // OK, we have a block; split it into Queues and free them
+    for( int i = 0; i < (SLICE_SIZE/sizeof(struct queue_s)); ++i ) {
+        _queue_free( block + i );
+    }
+
+    return( true );
+}
 
 //
-// _qnode_alloc() - allocate a QNode
+// _queue_make() - take a Queue from the free list and initialize it
+//
+// Parameters:
+//    cmp     comparison function, or NULL
+//    offset  location of the QLink within each entry
+//    kind    organization of the queue
 //
 // Returns:
-//    a pointer to the allocated QNode on success, else a NULL pointer
+//    a pointer to the newly-allocated queue on success, else NULL
 //
-static QNode *_qnode_alloc( void ) {
-    QNode *new;
+static Queue _queue_make( int (*cmp)(const void*,const void *),
+                          uint32 offset, uint32 kind ) {
+    Queue new;
 
-    // if there aren't any, allocate another slab of 'em
-    if( _free_qnodes == NULL ) {
-        // if the creation fails, report back to the caller
-        if( !_qnode_setup(false) ) {
+    // if there are no free Queues, create another batch of them
+    if( _free_queues == NULL ) {
+    // an allocation failure here is not critical
+        if( !_queue_setup(false) ) {
             return( NULL );
         }
     }
 
-    // take the first one off the free list
-    new = _free_qnodes;
-    _free_qnodes = new->next;
+    // remove the first entry from the free list
+    new = _free_queues;
+    _free_queues = (struct queue_s *) (new->head.next);
 
-    // make sure it isn't pointing back to the list
-    new->next = NULL;
+    // make sure it's empty
+    if( kind == Q_HEAP ) {
+        new->head.next = new->head.prev = NULL;
+    } else {
+        new->head.next = new->head.prev = &new->head;
+    }
+    new->head.child = NULL;
+    new->length = 0;
+
+    // set up the ordering for the queue
+    new->cmp = cmp;
+    new->offset = offset;
+    new->kind = kind;
 
+    // return it to the caller
     return( new );
 }
 
+/*
+** List queues
+*/
+
+//
+// _list_link() - link an entry into a list between two others
+//
+// Parameters:
+//    queue   the Queue to be manipulated
+//    qn      the link for the new entry
+//    prev    the link which will precede it
+//    next    the link which will follow it
+//
+static inline void _list_link( Queue queue, QLink *qn,
+                               QLink *prev, QLink *next ) {
+    qn->prev = prev;
+    qn->next = next;
+    prev->next = qn;
+    next->prev = qn;
+    queue->length += 1;
+}
+
 //
-// _qnode_free() - deallocate a QNode
+// _list_unlink() - unlink an entry from a list
 //
 // Parameters:
-//    node    a pointer to the QNode to be deallocated
+//    queue   the Queue to be manipulated
+//    qn      the link for the entry being removed
+//
+static inline void _list_unlink( Queue queue, QLink *qn ) {
+    qn->prev->next = qn->next;
+    qn->next->prev = qn->prev;
+    qn->next = qn->prev = NULL;
+    queue->length -= 1;
+}
+
+//
+// _list_insert() - insert an entry into a sorted list
 //
-// Panics if an attempt is made to deallocate a NULL pointer
+// Parameters:
+//    queue   the Queue to be manipulated
+//    qn      the link for the new entry
 //
-static void _qnode_free( QNode *node ) {
+static void _list_insert( Queue queue, QLink *qn ) {
+    void *data = DATA( queue, qn );
 
-    // attempting to free a NULL pointer is a capital offense!
-    assert( node );
+    // iterate until we either run out of entries, or we find the
+    // entry that should follow the new one; equal entries stay in
+    // FIFO order
+    QLink *curr = queue->head.next;
 
-    // do this the easy way - add it to the front of the free list
-    node->next = _free_qnodes;
-    node->data = NULL;
-    _free_qnodes = node;
+    while( curr != &queue->head &&
+           queue->cmp(data,DATA(queue,curr)) >= 0 ) {
+        curr = curr->next;
+    }
+
+    // curr is the successor (possibly the sentinel, i.e., the end)
+    _list_link( queue, qn, curr->prev, curr );
 }
 
+/*
+** Heap queues
+*/
+
 //
-// _qnode_setup() - allocate a slice of memory and turn it into QNodes
+// _heap_meld() - combine two heaps
 //
 // Parameters:
-//    critical   - true if this is a critical allocation, else false
+//    queue   the Queue being manipulated
+//    a, b    the roots of the two heaps
 //
 // Returns:
-//    true on success, else false
+//    the root of the combined heap
 //
-// If this is a critical allocation, we panic on allocation failure;
-// otherwise, we simply return "false" to indicate the failure.
+// The loser becomes the first child of the winner.  The 'next' and
+// 'prev' links of the winner are left for the caller to set.
 //
-static bool _qnode_setup( bool critical ) {
-    QNode *block;
+static QLink *_heap_meld( Queue queue, QLink *a, QLink *b ) {
 
-    // get a slice of free memory
-    block = (QNode *) _kalloc_slice();
-    if( block == NULL ) {
+    if( queue->cmp(DATA(queue,b),DATA(queue,a)) < 0 ) {
+        QLink *tmp = a;
+        a = b;
+        b = tmp;
+    }
 
-        // the allocation failed - should we give up?
-        if( critical ) {
-            // this is guaranteed to fail
-            assert( block );
+    b->prev = a;
+    b->next = a->child;
+    if( a->child != NULL ) {
+        a->child->prev = b;
+    }
+    a->child = b;
+
+    return( a );
+}
+
+//
+// _heap_combine() - combine a list of siblings into a single heap
+//
+// Parameters:
+//    queue   the Queue being manipulated
+//    first   the first sibling, or NULL
+//
+// Returns:
+//    the root of the resulting heap, or NULL
+//
+// This is the standard two-pass pairing:  meld the siblings in pairs
+// from left to right, then meld the results from right to left.
+//
+static QLink *_heap_combine( Queue queue, QLink *first ) {
+    QLink *pairs = NULL;
+
+    // first pass; 'pairs' collects the results, rightmost first
+    while( first != NULL ) {
+        QLink *a = first;
+        QLink *b = a->next;
+
+        if( b == NULL ) {
+            first = NULL;
+        } else {
+            first = b->next;
+            a = _heap_meld( queue, a, b );
         }
 
-        // no; report the failure
-        return( false );
+        a->next = pairs;
+        pairs = a;
     }
 
-    // free the qnodes!
-    for( int i = 0; i < (SLICE_SIZE/sizeof(QNode)); ++i ) {
-        // N.B.: if the slice size is not an integral multiple of
-        // the QNode size, this will leave a small internal fragment
-        // at the end of the allocated block of memory
-        _qnode_free( block + i );
+    if( pairs == NULL ) {
+        return( NULL );
     }
 
-    // all done - report our success
-    return( true );
+    // second pass
+    QLink *root = pairs;
+    pairs = pairs->next;
+
+    while( pairs != NULL ) {
+        QLink *a = pairs;
+        pairs = pairs->next;
+        root = _heap_meld( queue, root, a );
+    }
+
+    return( root );
 }
 
 //
-// _queue_setup() - allocate a slice of memory and turn it into Queues
+// _heap_set_root() - make a heap the contents of a queue
+//
+// Parameters:
+//    queue   the Queue being manipulated
+//    root    the new root, or NULL
 //
-// This is essentially identical to _qnode_setup(), but for Queues
-// instead of QNodes.
+static inline void _heap_set_root( Queue queue, QLink *root ) {
+
+    queue->head.next = root;
+    if( root != NULL ) {
+        root->prev = &queue->head;
+        root->next = NULL;
+    }
+}
+
+//
+// _heap_insert() - add an entry to a heap
 //
 // Parameters:
-//    critical   - true if this is a critical allocation, else false
+//    queue   the Queue to be manipulated
+//    qn      the link for the new entry
 //
-// Returns:
-//    true on success, else false
+static void _heap_insert( Queue queue, QLink *qn ) {
+
+    qn->next = qn->prev = qn->child = NULL;
+
+    if( queue->head.next == NULL ) {
+        _heap_set_root( queue, qn );
+    } else {
+        _heap_set_root( queue, _heap_meld(queue,queue->head.next,qn) );
+    }
+
+    queue->length += 1;
+}
+
 //
-// If this is a critical allocation, we panic on allocation failure;
-// otherwise, we simply return "false" to indicate the failure.
+// _heap_unlink() - remove an entry from a heap
 //
-static bool _queue_setup( bool critical ) {
-    struct queue_s *block;
+// Parameters:
+//    queue   the Queue to be manipulated
+//    qn      the link for the entry being removed
+//
+static void _heap_unlink( Queue queue, QLink *qn ) {
+    QLink *sub = _heap_combine( queue, qn->child );
 
-    block = (struct queue_s *) _kalloc_slice();
+    if( qn == queue->head.next ) {
 
-    // if this is a critical allocation and block is NULL, we're done for
-    assert( !critical || block );
+        // the root:  its children become the new heap
+        _heap_set_root( queue, sub );
 
-    // whew - not critical; NULL block is still a problem, though
-    if( block == NULL ) {
-        return( false );
+    } else {
+
+        // cut its subtree out of its parent's list of children
+        if( qn->prev->child == qn ) {
+            qn->prev->child = qn->next;
+        } else {
+            qn->prev->next = qn->next;
+        }
+        if( qn->next != NULL ) {
+            qn->next->prev = qn->prev;
+        }
+
+        // and put its children back
+        if( sub != NULL ) {
+            _heap_set_root( queue, _heap_meld(queue,queue->head.next,sub) );
+        }
     }
 
-    // OK, we have a block; split it into Queues and free them
-    for( int i = 0; i < (SLICE_SIZE/sizeof(struct queue_s)); ++i ) {
-        _queue_free( block + i );
+    qn->next = qn->prev = qn->child = NULL;
+    queue->length -= 1;
+}
+
+//
+// _heap_succ() - find the next entry in a preorder walk of a heap
+//
+// Parameters:
+//    queue   the Queue being examined
+//    qn      the current entry
+//
+// Returns:
+//    the next entry, or NULL at the end of the walk
+//
+static QLink *_heap_succ( Queue queue, QLink *qn ) {
+
+    if( qn->child != NULL ) {
+        return( qn->child );
     }
 
-    return( true );
+    while( qn != queue->head.next ) {
+        if( qn->next != NULL ) {
+            return( qn->next );
+        }
+        // climb to the parent:  back up to the first sibling first
+        while( qn->prev->child != qn ) {
+            qn = qn->prev;
+        }
+        qn = qn->prev;
+    }
+
+    return( NULL );
 }
 
 /*
@@ -214,25 +434,18 @@ static bool _queue_setup( bool critical ) {
 //
 void _queue_init( void ) {
 
-    // set up qnode list
-    _free_qnodes = NULL;
-    _qnode_setup( true );
-
     // set up queue list
     _free_queues = NULL;
     _queue_setup( true );
 
     // create the queues for the OS
-    _waiting = _queue_alloc( NULL );
+    _waiting = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
     assert( _waiting );
 
-    _reading = _queue_alloc( NULL );
-    assert( _reading );
-
-    _zombie = _queue_alloc( NULL );
+    _zombie = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
     assert( _zombie )
 
-    _sleeping = _queue_alloc( _wakeup_cmp );
+    _sleeping = _queue_alloc( _wakeup_cmp, QOFFSET(Pcb,qlink) );
     assert( _sleeping );
 
     // report that we are ready
@@ -245,34 +458,32 @@ void _queue_init( void ) {
 // Parameters:
 //    cmp    comparison function to use if this is an ordered Queue,
 //           else NULL (for a FIFO queue)
+//    offset where the QLink is in the objects to be queued
 //
 // Returns:
 //    a pointer to the newly-allocated queue on success, else NULL
 //
-Queue _queue_alloc( int (*cmp)(const void*,const void *) ) {
-    Queue new;
+Queue _queue_alloc( int (*cmp)(const void*,const void *), uint32 offset ) {
 
-    // if there are no free Queues, create another batch of them
-    if( _free_queues == NULL ) {
-    // an allocation failure here is not critical
-        if( !_queue_setup(false) ) {
-            return( NULL );
-        }
-    }
-
-    // remove the first entry from the free list
-    new = _free_queues;
-    _free_queues = (struct queue_s *) (new->head);
+    return( _queue_make(cmp, offset, cmp == NULL ? Q_FIFO : Q_HEAP) );
+}
 
-    // make sure it's empty
-    new->head = new->tail = NULL;
-    new->length = 0;
+//
+// _queue_alloc_sorted() - allocate an ordered Queue kept as a sorted list
+//
+// Parameters:
+//    cmp    comparison function to use
+//    offset where the QLink is in the objects to be queued
+//
+// Returns:
+//    a pointer to the newly-allocated queue on success, else NULL
+//
+Queue _queue_alloc_sorted( int (*cmp)(const void*,const void *),
+                           uint32 offset ) {
 
-    // set up the ordering for the queue
-    new->cmp = cmp;
+    assert1( cmp );
 
-    // return it to the caller
-    return( new );
+    return( _queue_make(cmp, offset, Q_SORTED) );
 }
 
 //
@@ -291,8 +502,8 @@ void _queue_free( Queue q ) {
         return;
     }
 
-    // overload the 'head' pointer
-    q->head = (QNode *) _free_queues;
+    // overload the 'head.next' pointer
+    q->head.next = (QLink *) _free_queues;
     _free_queues = (struct queue_s *) q;
 }
 
@@ -305,89 +516,31 @@ void _queue_free( Queue q ) {
 //
 // Parameters:
 //    queue   the Queue to be manipulated
-//    data    value to add to the queue
+//    data    entry to add to the queue
 //
-// Returns:
-//    a status indicating the result of the operation
+// The entry must not currently be on any queue.
 //
-Status _queue_enque( Queue queue, void *data ) {
-
-    // sanity: NULL queue?
-    if( queue == NULL ) {
-        return( E_PARAM );
-    }
-
-    // we'll need a QNode
-    QNode *qn = _qnode_alloc();
-    if( qn == NULL ) {
-        return( E_SPACE );
-    }
-
-    // OK, we have the QNode; fill in the data field
-    qn->data = data;
+void _queue_enque( Queue queue, void *data ) {
 
-    // if the queue is empty, this will become the first node
-    if( queue->length == 0 ) {
-        queue->head = queue->tail = qn;
-        queue->length = 1;
-        return( SUCCESS );
-    }
-
-    // sanity: the queue is not empty, so there must already
-    // be a first node - verify that this is the case
-    assert2( queue->head != 0 && queue->tail != 0 );
-
-    // if there is no comparison function, this is a FIFO queue
-    if( queue->cmp == 0 ) {
-        queue->tail->next = qn;
-        queue->tail = qn;
-        queue->length += 1;
-        return( SUCCESS );
-    }
-
-    // OK, this is an ordered queue; locate the insertion point
-    QNode *prev, *curr;
-
-    prev = NULL;
-    curr = queue->head;
-
-    // iterate until we either run out of nodes, or
-    // we find the node that should follow the new one
-    while( curr && queue->cmp(data,curr->data) >= 0 ) {
-        prev = curr;
-        curr = curr->next;
-    }
-
-    // curr prev
-    //   0    0   -> can't happen
-    //   0   !0   -> add at end of queue
-    //  !0    0   -> add at beginning
-    //  !0   !0   -> add in middle
-
-    // sanity:  at least one pointer must not be NULL
-    //         curr || prev
-    assert2( !(curr == NULL && prev == NULL) );
-
-    // curr always points to the successor, even if it's NULL
-    qn->next = curr;
-
-    // prev tells us whether or not there's a predecessor
-    if( prev == NULL ) {
-    // nope - this is the new head node
-        queue->head = qn;
-    } else {
-    // yes - we have a predecessor
-        prev->next = qn;
-    // if no successor, we're also the tail node
-        if( curr == NULL ) {
-            queue->tail = qn;
-        }
+    // sanity: NULL queue or entry?
+    assert1( queue );
+    assert1( data );
+
+    QLink *qn = LINK( queue, data );
+
+    // sanity: already on a queue?
+    assert2( qn->next == NULL && qn->prev == NULL && qn->child == NULL );
+
+    switch( queue->kind ) {
+    case Q_FIFO:
+        _list_link( queue, qn, queue->head.prev, &queue->head );
+        break;
+    case Q_SORTED:
+        _list_insert( queue, qn );
+        break;
+    default:
+        _heap_insert( queue, qn );
     }
-
-    // one more thing in the list
-    queue->length += 1;
-
-    return( SUCCESS );
 }
 
 //
@@ -409,28 +562,16 @@ void *_queue_deque( Queue queue ) {
         return( NULL );
     }
 
-    // OK, we have at least one element; remember it
-    QNode *qn = queue->head;
-
-    // unlink the head node
-    queue->head = qn->next;
-
-    // remember the data from this node, and free the node
-    void *data = qn->data;
-    _qnode_free( qn );
-
-    // we have shortened the queue
-    queue->length -= 1;
-
-    // if the queue is now empty, make sure the head 
-    // and tail pointers are both NULL
-    if( queue->length == 0 ) {
-        queue->tail = NULL;
-        assert2( queue->head == NULL );
+    // OK, we have at least one element; unlink it
+    QLink *qn = queue->head.next;
+    if( queue->kind == Q_HEAP ) {
+        _heap_unlink( queue, qn );
+    } else {
+        _list_unlink( queue, qn );
     }
 
-    // send the removed data back
-    return( data );
+    // send the removed entry back
+    return( DATA(queue,qn) );
 }
 
 //
@@ -438,73 +579,33 @@ void *_queue_deque( Queue queue ) {
 //
 // Parameters:
 //    queue   the queue to be manipulated
-//    data    the value to be located and removed
+//    data    the entry to be removed
 //
 // Returns:
-//    the data field from the removed item, or NULL
+//    the removed entry, or NULL if it was not on a queue
+//
+// The entry must be on this queue; its links are used directly, so
+// no search is required.
 //
 void *_queue_remove( Queue queue, void *data ) {
-    QNode *curr, *prev;
-    
+
     // sanity check!
     assert1( queue );
-    
+    assert1( data );
+
+    QLink *qn = LINK( queue, data );
+
     // can't get blood from a stone, as they say
-    if( queue->length < 1 ) {
+    if( queue->length < 1 || qn->prev == NULL ) {
         return( NULL );
     }
-    
-    // find this entry in the queue
-    //
-    // this is a basic singly-linked list removal
-
-    prev = NULL;
-    curr = queue->head;
-    
-    while( curr && curr->data != data ) {
-        prev = curr;
-        curr = curr->next;
-    }
-    
-    // did we find it?
-    if( !curr ) {
-        // no - not in this queue
-        return( NULL );
-    }
-    
-    /*
-    ** found it!  we have these possible situations:
-    **
-    **  prev  curr  next  situation
-    **    *     0     *   can't happen
-    **    0    !0     0   removing only node
-    **    0    !0    !0   removing first node
-    **   !0    !0    !0   removing middle node
-    **   !0    !0     0   removing last node
-    **
-    ** removing the only node is equivalent to removing *both* the
-    ** first node *and* the last node, so we can handle it that way
-    */
-
-    if( prev ) {
-        // middle or last node
-        prev->next = curr->next;
+
+    if( queue->kind == Q_HEAP ) {
+        _heap_unlink( queue, qn );
     } else {
-        // first node
-        queue->head = curr->next;
-    }
-    
-    if( curr->next == NULL ) {
-        // last node
-        queue->tail = prev;
+        _list_unlink( queue, qn );
     }
-    
-    // we've reduced the queue length
-    queue->length -= 1;
-    
-    // reclaim the qnode
-    _qnode_free( curr );
-    
+
     // the data we found is the data we were looking for
     return( data );
 }
@@ -516,13 +617,10 @@ void *_queue_remove( Queue queue, void *data ) {
 //    q    the Queue to be examined
 //
 // Returns:
-//    the data field from the first entry in the Queue, else NULL
+//    the first entry in the Queue, else NULL
 //
 // If the supplied Queue pointer is NULL or there is nothing in the
-// Queue, we return a NULL pointer.  This is indistinguishable from
-// the return value from a non-empty Queue if the first entry in
-// that Queue is itself 0 or a NULL pointer.  The calling routine
-// must verify that the Queue was not empty.
+// Queue, we return a NULL pointer.
 //
 void *_queue_front( Queue q ) {
 
@@ -536,8 +634,8 @@ void *_queue_front( Queue q ) {
         return( NULL );
     }
 
-    // return whatever was there
-    return( q->head->data );
+    // return whatever was there (the root, for a heap)
+    return( DATA(q,q->head.next) );
 }
 
 //
@@ -569,12 +667,15 @@ uint32 _queue_length( Queue q ) {
 // Queue iteration
 //
 // We assume that the queue will not be modified while we're using an
-// iterator to step through it.  If the OS is modified so that it is
-// reentrant, that constraint may be violated.
+// iterator to step through it, except that the entry most recently
+// returned by _queue_next() may be removed from a FIFO or sorted
+// queue.  If the OS is modified so that it is reentrant, that
+// constraint may be violated.
 //
-// Our QIter type is just a void*, and points to the current QNode in
-// the queue.  We do this because the QNode is a private type and isn't
-// available outside this module, so we use void* as a generic type.
+// A QIter holds the link of the current entry (NULL once we have run
+// off the end of the queue) and the queue being examined.  The entries
+// of a heap are visited in preorder, which is not sorted order; only
+// the first entry visited is guaranteed to be the smallest.
 //
 
 //
@@ -584,18 +685,20 @@ uint32 _queue_length( Queue q ) {
 //      queue   the Queue to be examined
 //
 // Returns:
-//      a pointer to the first element in the Queue (really a
-//      pointer to the first QNode in the Queue)
+//      an iterator positioned at the first element in the Queue
 //
 QIter _queue_start( Queue q ) {
+    QIter iter;
+
+    iter.queue = q;
+    iter.link = NULL;
 
     // NULL queue pointer means there's nothing in it
-    if( q == NULL ) {
-        return( NULL );
+    if( q != NULL && q->length > 0 ) {
+        iter.link = q->head.next;
     }
 
-    // first element in the queue
-    return( q->head );
+    return( iter );
 }
 
 //
@@ -609,44 +712,49 @@ QIter _queue_start( Queue q ) {
 //
 void *_queue_current( QIter iter ) {
 
-    // NULL iterator means we've run off the end of the queue
-    if( iter == NULL ) {
+    // NULL link means we've run off the end of the queue
+    if( iter.link == NULL ) {
         return( NULL );
     }
 
-    // return the current data value
-    return( ( (QNode *) iter)->data );
+    // return the current entry
+    return( DATA(iter.queue,iter.link) );
 }
 
 //
-// _queue_next() - return the current node's data, and advance the iterator
+// _queue_next() - return the current element, and advance the iterator
 //
 // Parameter:
 //    iter   a pointer to the iterator being advanced
 //
 // Returns:
-//    a pointer to the element just removed
+//    a pointer to the element just passed
 //
 void *_queue_next( QIter *iter ) {
-    QNode *qn;
 
     // NULL iter means bad news!
     assert2( iter );
 
-    // NULL iter contents means we're off the end of the queue
-    if( *iter == NULL ) {
+    // NULL link means we're off the end of the queue
+    if( iter->link == NULL ) {
         return( NULL );
     }
 
-    // remember the current node and its data
-    qn = (QNode *) *iter;
-    void *data = qn->data;
+    // remember the current entry
+    QLink *qn = iter->link;
 
     // advance the iterator
-    *iter = qn->next;
+    if( iter->queue->kind == Q_HEAP ) {
+        iter->link = _heap_succ( iter->queue, qn );
+    } else {
+        iter->link = qn->next;
+        if( iter->link == &iter->queue->head ) {
+            iter->link = NULL;
+        }
+    }
 
-    // return the data from the node we just left
-    return( data );
+    // return the entry we just left
+    return( DATA(iter->queue,qn) );
 }
 
 /*
@@ -668,12 +776,13 @@ void _queue_dump( const char *msg, Queue q ) {
     }
 
     // first, the basic data
-    __cio_printf( "head %08x tail %08x %d items",
-                  (uint32) q->head, (uint32) q->tail, q->length );
+    __cio_printf( "first %08x %d items", (uint32) _queue_front(q),
+                  q->length );
 
     // next, how the queue is ordered
     if( q->cmp ) {
-        __cio_printf( " cmp %08x\n", (uint32) q->cmp );
+        __cio_printf( " cmp %08x %s\n", (uint32) q->cmp,
+                      q->kind == Q_HEAP ? "heap" : "sorted" );
     } else {
         __cio_puts( " FIFO\n" );
     }
@@ -681,13 +790,13 @@ void _queue_dump( const char *msg, Queue q ) {
     // if there are members in the queue, dump the first five data pointers
     if( q->length > 0 ) {
         __cio_puts( " data: " );
-        QNode *tmp;
+        QIter iter = _queue_start( q );
         int i = 0;
-        for( tmp = q->head; i < 5 && tmp != NULL; ++i, tmp = tmp->next ) {
-            __cio_printf( " [%08x]", (uint32) tmp->data );
+        for( ; i < 5 && _queue_current(iter) != NULL; ++i ) {
+            __cio_printf( " [%08x]", (uint32) _queue_next(&iter) );
         }
 
-        if( tmp != NULL ) {
+        if( _queue_current(iter) != NULL ) {
             __cio_puts( " ..." );
         }
 
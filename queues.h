@@ -27,13 +27,33 @@
 ** Types
 */
 
+// Queues are intrusive:  each object which can be placed on a queue
+// contains a QLink, which the queue uses to link its members together.
+// An object can be on only one queue at a time through a given QLink.
+// No memory is allocated to add an object to a queue, so enqueueing
+// cannot fail.  An object can be removed from anywhere in a FIFO queue
+// in constant time, and from an ordered queue in O(log n) time.
+
+typedef struct qlink_s {
+    struct qlink_s *next;
+    struct qlink_s *prev;
+    struct qlink_s *child;  // used only by ordered queues
+} QLink;
+
+// byte offset of a QLink within the objects on a queue
+
+#define QOFFSET(type,field)     ((uint32) &(((type *) 0)->field))
+
 // The queue itself is an opaque type
 
 typedef struct queue_s *Queue;
 
 // We also provide a queue iterator
 
-typedef void *QIter;
+typedef struct qiter_s {
+    QLink *link;        // current element
+    Queue queue;        // the queue being examined
+} QIter;
 
 /*
 ** Globals
@@ -58,11 +78,26 @@ void _queue_init( void );
 // Parameters:
 //    cmp    comparison function to use if this is an ordered Queue,
 //           else NULL (for a FIFO queue)
+//    offset where the QLink is in the objects to be queued (use
+//           QOFFSET() to compute this)
 //
 // Returns:
 //    a pointer to the newly-allocated queue on success, else NULL
 //
-Queue _queue_alloc( int (*cmp)(const void*,const void*) );
+// Ordered queues are kept as heaps; entries which compare equal may
+// leave the queue in any order.
+//
+Queue _queue_alloc( int (*cmp)(const void*,const void*), uint32 offset );
+
+//
+// _queue_alloc_sorted() - allocate an ordered Queue kept as a sorted list
+//
+// As _queue_alloc(), but insertion takes linear time; equal entries
+// leave the queue in the order they arrived.  Used by the benchmarks
+// to compare against the heap.
+//
+Queue _queue_alloc_sorted( int (*cmp)(const void*,const void*),
+                           uint32 offset );
 
 //
 // _queue_free() - deallocate a Queue
@@ -81,7 +116,9 @@ void _queue_free( Queue queue );
 //
 // _queue_enque - add something to a queue
 //
-Status _queue_enque( Queue queue, void *data );
+// The object must not already be on a queue.  This cannot fail.
+//
+void _queue_enque( Queue queue, void *data );
 
 //
 // _queue_deque - remove something from a queue
@@ -91,6 +128,8 @@ void *_queue_deque( Queue queue );
 //
 // _queue_remove - remove a specific entry from a queue
 //
+// The entry must be on this queue.
+//
 void *_queue_remove( Queue queue, void *entry );
 
 //
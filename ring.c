@@ -0,0 +1,191 @@
+/*
+** SCCS ID:	@(#)ring.c	1.1	3/30/20
+**
+** File:	ring.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Single-producer/single-consumer ring buffer implementation
+*/
+
+#define	__SP_KERNEL__
+
+#include "common.h"
+
+#include "ring.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// keep the compiler from moving memory accesses across this point
+//
+// x86 does not reorder stores with other stores, or loads with other
+// loads, so nothing more is needed to publish an index update
+
+#define	BARRIER()	__asm__ __volatile__( "" ::: "memory" )
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+//
+// __ring_init() - initialize an empty ring buffer
+//
+void __ring_init( Ring *ring, void *buf, uint32 size ) {
+
+    // the size must be a power of two
+    assert( size != 0 && (size & (size - 1)) == 0 );
+
+    ring->head = ring->tail = 0;
+    ring->mask = size - 1;
+    ring->buf = (uint8 *) buf;
+}
+
+//
+// __ring_count() - number of bytes waiting to be read
+//
+uint32 __ring_count( Ring *ring ) {
+
+    return( ring->head - ring->tail );
+}
+
+//
+// __ring_space() - number of bytes which can be written
+//
+uint32 __ring_space( Ring *ring ) {
+
+    return( ring->mask + 1 - (ring->head - ring->tail) );
+}
+
+//
+// __ring_put() - add one byte to a ring (producer)
+//
+bool __ring_put( Ring *ring, uint8 ch ) {
+    uint32 head = ring->head;
+
+    if( head - ring->tail > ring->mask ) {
+        return( false );
+    }
+
+    ring->buf[ head & ring->mask ] = ch;
+    BARRIER();
+    ring->head = head + 1;
+
+    return( true );
+}
+
+//
+// __ring_get() - remove one byte from a ring (consumer)
+//
+int __ring_get( Ring *ring ) {
+    uint32 tail = ring->tail;
+
+    if( ring->head == tail ) {
+        return( -1 );
+    }
+
+    int ch = ring->buf[ tail & ring->mask ];
+    BARRIER();
+    ring->tail = tail + 1;
+
+    return( ch );
+}
+
+//
+// __ring_write() - add as many bytes as will fit to a ring (producer)
+//
+// The bytes are copied in at most two pieces:  up to the end of the
+// buffer, and then from its beginning.
+//
+uint32 __ring_write( Ring *ring, const void *buf, uint32 len ) {
+    uint32 head = ring->head;
+    uint32 space = ring->mask + 1 - (head - ring->tail);
+
+    if( len > space ) {
+        len = space;
+    }
+
+    if( len > 0 ) {
+        uint32 pos = head & ring->mask;
+        uint32 first = ring->mask + 1 - pos;
+
+        if( first > len ) {
+            first = len;
+        }
+        __memcpy( ring->buf + pos, buf, first );
+        if( len > first ) {
+            __memcpy( ring->buf, (const uint8 *) buf + first, len - first );
+        }
+
+        BARRIER();
+        ring->head = head + len;
+    }
+
+    return( len );
+}
+
+//
+// __ring_read() - remove up to 'len' bytes from a ring (consumer)
+//
+uint32 __ring_read( Ring *ring, void *buf, uint32 len ) {
+    uint32 tail = ring->tail;
+    uint32 count = ring->head - tail;
+
+    if( len > count ) {
+        len = count;
+    }
+
+    if( len > 0 ) {
+        uint32 pos = tail & ring->mask;
+        uint32 first = ring->mask + 1 - pos;
+
+        if( first > len ) {
+            first = len;
+        }
+        __memcpy( buf, ring->buf + pos, first );
+        if( len > first ) {
+            __memcpy( (uint8 *) buf + first, ring->buf, len - first );
+        }
+
+        BARRIER();
+        ring->tail = tail + len;
+    }
+
+    return( len );
+}
+
+//
+// __ring_find() - look for a byte among the oldest in a ring (consumer)
+//
+uint32 __ring_find( Ring *ring, uint8 ch, uint32 limit ) {
+    uint32 tail = ring->tail;
+    uint32 count = ring->head - tail;
+
+    if( limit > count ) {
+        limit = count;
+    }
+
+    for( uint32 n = 0; n < limit; ++n ) {
+        if( ring->buf[ (tail + n) & ring->mask ] == ch ) {
+            return( n + 1 );
+        }
+    }
+
+    return( limit );
+}
+
+//
+// __ring_peek() - examine a byte without removing it (consumer)
+//
+int __ring_peek( Ring *ring, uint32 n ) {
+    uint32 tail = ring->tail;
+
+    if( n >= ring->head - tail ) {
+        return( -1 );
+    }
+
+    return( ring->buf[ (tail + n) & ring->mask ] );
+}
@@ -0,0 +1,123 @@
+/*
+** SCCS ID:	@(#)ring.h	1.1	3/30/20
+**
+** File:	ring.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Single-producer/single-consumer ring buffer declarations
+**
+** A Ring is a circular byte buffer whose size is a power of two.  It
+** may be used by exactly one producer and one consumer at a time,
+** which may run concurrently (e.g., an interrupt handler and a process)
+** without disabling interrupts:  the producer is the only one to change
+** 'head', and the consumer is the only one to change 'tail'.  Each
+** stores its index only after the bytes it covers have been written
+** or read.
+**
+** The indices run freely and are masked when used, so the number of
+** bytes in the ring is always (head - tail), even after they wrap.
+*/
+
+#ifndef _RING_H_
+#define _RING_H_
+
+#include "types.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Types
+*/
+
+typedef struct ring_s {
+    volatile uint32 head;   // next byte to be written (producer only)
+    volatile uint32 tail;   // next byte to be read (consumer only)
+    uint32 mask;            // size of the buffer, minus one
+    uint8 *buf;             // the buffer
+} Ring;
+
+/*
+** Prototypes
+*/
+
+//
+// __ring_init() - initialize an empty ring buffer
+//
+// @param ring  The Ring
+// @param buf   Its buffer
+// @param size  Size of the buffer; must be a power of two
+//
+void __ring_init( Ring *ring, void *buf, uint32 size );
+
+//
+// __ring_count() - number of bytes waiting to be read
+//
+uint32 __ring_count( Ring *ring );
+
+//
+// __ring_space() - number of bytes which can be written
+//
+uint32 __ring_space( Ring *ring );
+
+//
+// __ring_put() - add one byte to a ring (producer)
+//
+// @returns true on success, false if the ring was full
+//
+bool __ring_put( Ring *ring, uint8 ch );
+
+//
+// __ring_get() - remove one byte from a ring (consumer)
+//
+// @returns The byte, or -1 if the ring was empty
+//
+int __ring_get( Ring *ring );
+
+//
+// __ring_write() - add as many bytes as will fit to a ring (producer)
+//
+// @returns The number of bytes added
+//
+uint32 __ring_write( Ring *ring, const void *buf, uint32 len );
+
+//
+// __ring_read() - remove up to 'len' bytes from a ring (consumer)
+//
+// @returns The number of bytes removed
+//
+uint32 __ring_read( Ring *ring, void *buf, uint32 len );
+
+//
+// __ring_find() - look for a byte among the oldest in a ring (consumer)
+//
+// @param ch     The byte to look for
+// @param limit  How many bytes to examine, at most
+//
+// @returns The number of bytes up to and including the first 'ch', or
+//          the number examined if 'ch' wasn't found
+//
+uint32 __ring_find( Ring *ring, uint8 ch, uint32 limit );
+
+//
+// __ring_peek() - examine a byte without removing it (consumer)
+//
+// @param n  Which byte, counting from the oldest (0)
+//
+// @returns The byte, or -1 if there are not that many in the ring
+//
+int __ring_peek( Ring *ring, uint32 n );
+
+#endif
+
+#endif
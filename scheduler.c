@@ -15,6 +15,9 @@
 #include "common.h"
 
 #include "scheduler.h"
+#include "syscalls.h"
+#include "kthread.h"
+#include "fpu.h"
 
 /*
 ** PRIVATE DEFINITIONS
@@ -32,6 +35,8 @@
 ** PUBLIC GLOBAL VARIABLES
 */
 
+bool _need_resched;
+
 /*
 ** PRIVATE FUNCTIONS
 */
@@ -46,13 +51,14 @@
 void _sched_init( void ) {
 
     // create the ready queue
-    _ready = _queue_alloc( NULL );
+    _ready = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
 
     // if we can't, life is not worth living
     assert( _ready );
 
     // no current process yet
     _current = NULL;
+    _need_resched = false;
 
     // announce that we're ready
     __cio_puts( " SCHED" );
@@ -74,8 +80,8 @@ void _schedule( Pcb *pcb ) {
     // queue membership
     pcb->queue = _ready;
 
-    // add it to the collection; failure is not an option!
-    assert( _queue_enque(_ready,(void *)pcb) == SUCCESS );
+    // add it to the collection
+    _queue_enque( _ready, (void *) pcb );
 }
 
 //
@@ -83,14 +89,6 @@ void _schedule( Pcb *pcb ) {
 //
 void _dispatch( void ) {
 
-#ifdef CONSOLE_SHELL
-    // check to see if there is any console input
-    if( __cio_input_queue() > 0 ) {
-        // yes - deal with it
-        _shell( 'h' );
-    }
-#endif
-
     // if there isn't anyone waiting to run, stop
     // and smell the roses until something happens
 
@@ -99,7 +97,17 @@ void _dispatch( void ) {
         // __pause();
     // }
 
+    // if nobody is ready, use the time to service any polled
+    // system call rings (which may make someone ready)
+
     if( _queue_length(_ready) == 0 ) {
+        _sys_ring_poll();
+    }
+
+    if( _queue_length(_kready) > 0 ) {
+        // kernel threads with deferred work go first
+        _current = (Pcb *) _queue_deque( _kready );
+    } else if( _queue_length(_ready) == 0 ) {
         _current = _idle_pcb;
     } else {
         // dispatch the first thing on the queue
@@ -113,4 +121,48 @@ void _dispatch( void ) {
     _current->queue = NULL;
     _current->state = RUNNING;
     _current->quantum = QUANTUM_STD;
+
+    // it may not use another process' FPU state
+    _fpu_switch( _current );
+}
+
+//
+// _preempt() - take the CPU away from the current process
+//
+void _preempt( void ) {
+
+    // if we interrupted a system call, that call has to finish first
+    if( _isr_depth > 1 ) {
+        _need_resched = true;
+        return;
+    }
+
+    // idle() never goes on the ready queue
+    if( _current != _idle_pcb ) {
+        _schedule( _current );
+    }
+    _dispatch();
+}
+
+//
+// _resched() - carry out a deferred preemption
+//
+void _resched( void ) {
+
+    _need_resched = false;
+
+    // the system call may already have given the CPU away
+    if( _current->state == RUNNING ) {
+        _preempt();
+    }
+}
+
+//
+// _preempt_point() - let pending interrupts in during a system call
+//
+void _preempt_point( void ) {
+
+    if( _in_syscall && _isr_depth == 1 ) {
+        __allow_ints();
+    }
 }
@@ -35,6 +35,9 @@
 ** Globals
 */
 
+// has a nested interrupt asked for the current process to be preempted?
+extern bool _need_resched;
+
 /*
 ** Prototypes
 */
@@ -56,6 +59,31 @@ void _schedule( Pcb *pcb );
 //
 void _dispatch( void );
 
+//
+// _preempt() - take the CPU away from the current process
+//
+// If called from a nested interrupt, the preemption is deferred until
+// the outermost interrupt or system call returns (see _resched()).
+//
+void _preempt( void );
+
+//
+// _resched() - carry out a deferred preemption
+//
+// Called from __isr_restore, with interrupts disabled, as the
+// outermost interrupt or system call is returning.
+//
+void _resched( void );
+
+//
+// _preempt_point() - let pending interrupts in during a system call
+//
+// Called at points in long system calls where no data structure
+// that an interrupt handler might touch is in an inconsistent state.
+// Does nothing unless the caller is running as part of a system call.
+//
+void _preempt_point( void );
+
 #endif
 
 #endif
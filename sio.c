@@ -11,45 +11,92 @@
 **
 ** Our SIO scheme is very simple:
 **
+**  Ports:  Up to four UARTs are supported, at the standard addresses
+**      of COM1 through COM4.  COM1 is always used; the others are
+**      used if a UART is found there.  Each port has its own buffers,
+**      interrupt enable state, data rate, read settings and queues of
+**      blocked processes, and is its own I/O channel (CHAN_COM1
+**      through CHAN_COM4).  Kernel output goes to COM1.
+**
+**      COM1 and COM3 share IRQ 4, and COM2 and COM4 share IRQ 3.  The
+**      ISR services every port on its line until none of them has an
+**      event pending; as the lines are edge-triggered, stopping any
+**      sooner could leave a port's interrupt asserted with no new edge
+**      to report it.
+**
+**  Modes:  Each port has a line discipline, set with ioctl()
+**      (IOC_SIO_MODE).  A cooked port (the default) maps CR to LF on
+**      input and LF to CRLF in _sio_writec(), and a newline completes
+**      a read; an echoing port also sends each input character back.
+**      A raw port does none of this:  input is copied from the FIFO
+**      to the buffer, and from there to the reader, a block at a time
+**      with no per-character work.  Data written with write() is
+**      never translated.
+**
 **  Input:  We maintain a buffer of incoming characters that haven't
 **      yet been read by processes.  When a character comes in,
-**      if there is no process waiting for it, it goes in the 
+**      if there is no process waiting for it, it goes in the
 **      buffer; otherwise, the first waiting process is awakened
 **      and it gets the character.
 **
-**      When a process invokes readch(), if there is a character in
-**      the input buffer, the process gets it; otherwise, it is
-**      blocked until input appears
+**      When a process invokes read(), _sio_read() gives it the
+**      buffered characters.  If that doesn't complete the read, the
+**      process is blocked, and more characters are gathered into its
+**      buffer as they arrive.  A read completes when:
 **
-**      Communication with system calls is via two routines.
-**      _sio_readc() returns the first available character (if
-**      there is one), resetting the input variables if this was
-**      the last character in the buffer.  If there are no
-**      characters in the buffer, _sio_read() returns a -1
-**      (presumably so the requesting process can be blocked).
+**        - the caller's buffer is full;
+**        - a newline arrives (except in raw mode); or
+**        - at least 'vmin' characters have arrived, and either
+**          'vtime' is 0 or no character has arrived for 'vtime' ms.
+**
+**      vmin and vtime are set with ioctl() (IOC_SIO_VMIN and
+**      IOC_SIO_VTIME), in the spirit of the termios settings of the
+**      same names.  With both 0, reads never block.  Blocked readers
+**      are served in order; only the first one is given characters.
 **
-**      _sio_reads() copies the contents of the input buffer into
-**      a user-supplied buffer.  It returns the number of characters
-**      copied.  If there are no characters available, return a
-**      -1.
+**      _sio_readc() returns the first available character (if
+**      there is one), or -1.  _sio_reads() copies as much of the
+**      input buffer as will fit into a buffer, without blocking.
 **
 **  Output: We maintain a buffer of outgoing characters that haven't
-**      yet been sent to the device, and an indication of whether
-**      or not we are in the middle of a transmit sequence.  When
-**      an interrupt comes in, if there is another character to
-**      send we copy it to the transmitter buffer; otherwise, we
-**      end the transmit sequence.
+**      yet been sent to the device.  When a transmitter interrupt
+**      comes in, if there is another character to send we copy it
+**      to the transmitter buffer; otherwise, we end the transmit
+**      sequence by disabling transmitter interrupts.
 **
 **      Communication with user processes is via three functions.
 **      _sio_writec() writes a single character; _sio_write()
 **      writes a sized buffer full of characters; _sio_puts()
-**      prints a NUL-terminated string.  If we are in the middle
-**      of a transmit sequence, all characters will be added
-**      to the output buffer (from where they will be sent
-**      automatically); otherwise, we send the first character
-**      directly, add the rest of the characters (if there are
-**      any) to the output buffer, and set the "sending" flag
-**      to indicate that we're expecting a transmitter interrupt.
+**      prints a NUL-terminated string.  All characters are added
+**      to the output buffer, after which transmitter interrupts
+**      are enabled; if the transmitter is idle, this immediately
+**      raises an interrupt, which starts the transmit sequence.
+**      These never block; characters which don't fit are lost.
+**
+**      write() uses _sio_write_wait() instead.  If the whole buffer
+**      doesn't fit, the process is blocked on the port's queue of
+**      writers, and the rest of its buffer is copied in as the
+**      transmitter drains the output buffer; it is awakened with the
+**      full count once everything has been accepted.  Blocked writers
+**      are served in order, and later writers wait behind them.  The
+**      output buffer holds SIO_OBUF_SIZE characters, and is
+**      allocated when the port is initialized.
+**
+**  Both buffers are single-producer/single-consumer Rings (see
+**  ring.h), with the ISR at one end and processes at the other, so
+**  the consumers needn't disable interrupts to use them.  Echoing
+**  makes the ISR a second producer for the output buffer, so the
+**  other producers keep it out by disabling interrupts.
+**
+**  FIFOs:  The 16550 FIFOs are used in both directions.  The receiver
+**      interrupts when SIO_RX_TRIG characters have arrived, or when
+**      fewer have been waiting for a few character times (the FIFO
+**      timeout); either way, the ISR reads characters until the LSR
+**      says the FIFO is empty.  The characters the interrupt says
+**      are there are read without consulting the LSR.  Each transmitter interrupt means the
+**      transmit FIFO is empty, so the ISR refills it with up to 16
+**      characters.  On a UART without working FIFOs, one character
+**      is moved per interrupt.
 */
 
 #define __SP_KERNEL__
@@ -62,10 +109,14 @@
 
 #include "sio.h"
 
+#include "clock.h"
+#include "ring.h"
 #include "queues.h"
 #include "process.h"
 #include "scheduler.h"
 #include "kernel.h"
+#include "kthread.h"
+#include "kmem.h"
 
 #include "klib.h"
 
@@ -73,29 +124,128 @@
 ** PRIVATE DEFINITIONS
 */
 
-#define BUF_SIZE    2048
+#define BUF_SIZE    2048    // input buffer size; must be a power of two
+
+// size of the output buffer; this may be overridden with
+// -DSIO_OBUF_SIZE=n (a power of two)
+
+#ifndef SIO_OBUF_SIZE
+#define SIO_OBUF_SIZE   PAGE_SIZE
+#endif
+
+#if SIO_OBUF_SIZE < 16 || (SIO_OBUF_SIZE & (SIO_OBUF_SIZE - 1)) != 0
+#error "SIO_OBUF_SIZE must be a power of two, at least 16"
+#endif
+
+// blocked writers are resumed once this much of the output
+// buffer is free
+
+#define OBUF_LOW_WATER  (SIO_OBUF_SIZE / 4)
+
+// receive FIFO interrupt level, in characters (1, 4, 8 or 14); this
+// may be overridden with -DSIO_RX_TRIG=n
+
+#ifndef SIO_RX_TRIG
+#define SIO_RX_TRIG 8
+#endif
+
+#if SIO_RX_TRIG == 1
+#define RX_FIFO_LEVEL   UA5_FCR_RX_FIFO_1
+#elif SIO_RX_TRIG == 4
+#define RX_FIFO_LEVEL   UA5_FCR_RX_FIFO_4
+#elif SIO_RX_TRIG == 8
+#define RX_FIFO_LEVEL   UA5_FCR_RX_FIFO_8
+#elif SIO_RX_TRIG == 14
+#define RX_FIFO_LEVEL   UA5_FCR_RX_FIFO_14
+#else
+#error "SIO_RX_TRIG must be 1, 4, 8 or 14"
+#endif
+
+// size of the 16550 FIFOs
+
+#define TX_FIFO_SIZE    16
+#define RX_FIFO_SIZE    16
+
+// initial read completion settings (see ioctl())
+
+#define SIO_VMIN        1
+#define SIO_VTIME_MS    20
+
+// initial data rate, and the rate of a divisor of 1
+
+#define SIO_BAUD        9600
+#define BAUD_CLOCK      115200
+
+// uart.h describes the registers of COM1; PORT() gives the address
+// of the same register on another port
+
+#define PORT(p,reg)     ((p)->base + ((reg) - UA4_PORT))
+
+// the port number of a port
+
+#define PORTNUM(p)      ((uint32) ((p) - _ports))
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+typedef struct sioport_s {
+    uint16 base;            // I/O address of the UART
+    uint8 vector;           // its interrupt vector
+    bool present;           // is there a UART there?
+    uint8 ier;              // interrupt enable register contents
+    uint32 tx_burst;        // characters written per TX interrupt
+    uint32 baud;            // data rate, in bits per second
+    uint32 mode;            // line discipline (SIO_MODE_*)
+
+    Ring in;                // input character buffer
+    Ring out;               // output character buffer
+
+    bool rx_deferred;       // has delivery to readers been deferred?
+    bool tx_deferred;       // has resumption of writers been deferred?
+
+    Queue reading;          // processes blocked on input
+    Queue writing;          // processes blocked on output
+
+    // read completion settings
+    uint32 vmin;            // characters before a read may complete
+    uint32 vtime_ms;        // inter-character timeout, in ms
+    Time vtime;             // ... and in clock ticks
+
+    // progress of the reader at the front of the 'reading' queue
+    Pcb *rd_pcb;            // that reader, or NULL
+    uint32 rd_got;          // characters it has been given
+    Time rd_last;           // when it last got one (or started)
+
+    // progress of the writer at the front of the 'writing' queue
+    Pcb *wr_pcb;            // that writer, or NULL
+    uint32 wr_done;         // characters accepted from it
+
+    // statistics
+    uint32 rx_ints;         // receive and FIFO timeout interrupts
+    uint32 rx_bytes;        // characters received
+    uint32 rx_dropped;      // ... and discarded (buffer full)
+    uint32 tx_ints;         // transmitter interrupts
+    uint32 tx_bytes;        // characters sent
+    uint32 tx_blocked;      // writes which had to wait for space
+} SioPort;
 
 /*
 ** PRIVATE GLOBALS
 */
 
-    // input character buffer
-static char _inbuffer[ BUF_SIZE ];
-static char *_inlast;
-static char *_innext;
-static uint32 _incount;
+// where the ports are, and which interrupt each one uses
 
-    // output character buffer
-static char _outbuffer[ BUF_SIZE ];
-static char *_outlast;
-static char *_outnext;
-static uint32 _outcount;
+static const uint16 _sio_base[ SIO_PORTS ] = {
+    UA4_COM1_IOADDR, UA4_COM2_IOADDR, UA4_COM3_IOADDR, UA4_COM4_IOADDR
+};
 
-    // output control flag
-static int _sending;
+static const uint8 _sio_vector[ SIO_PORTS ] = {
+    INT_VEC_SERIAL_PORT_1, INT_VEC_SERIAL_PORT_2,
+    INT_VEC_SERIAL_PORT_1, INT_VEC_SERIAL_PORT_2
+};
 
-    // interrupt register status
-static uint8 _ier;
+static SioPort _ports[ SIO_PORTS ];
 
 /*
 ** PUBLIC GLOBAL VARIABLES
@@ -106,148 +256,437 @@ static uint8 _ier;
 */
 
 /*
-** _sio_isr(vector,ecode)
+** _sio_gather(p,buf,len)
 **
-** Interrupt handler for the SIO module.  Handles all pending
-** events (as described by the SIO controller).
+** Move buffered characters into the buffer of the port's current
+** reader (rd_pcb), stopping after a newline unless the port is raw.
+**
+** returns true if that completes the read
 */
 
-static void _sio_isr( int vector, int ecode ) {
+static bool _sio_gather( SioPort *p, char *buf, uint32 len ) {
+    bool raw = p->mode == SIO_MODE_RAW;
+    uint32 n;
+
+    if( raw ) {
+        n = __ring_read( &p->in, buf + p->rd_got, len - p->rd_got );
+    } else {
+        n = __ring_find( &p->in, '\n', len - p->rd_got );
+        __ring_read( &p->in, buf + p->rd_got, n );
+    }
+
+    if( n > 0 ) {
+        p->rd_got += n;
+        p->rd_last = _system_time;
+    }
+
+    if( p->rd_got >= len ) {
+        return( true );
+    }
+
+    if( !raw && p->rd_got > 0 && buf[p->rd_got - 1] == '\n' ) {
+        return( true );
+    }
+
+    if( p->rd_got < p->vmin ) {
+        return( false );
+    }
+
+    return( p->vtime == 0 || _system_time - p->rd_last >= p->vtime );
+}
+
+/*
+** _sio_rx_work(port)
+**
+** Deferred work for the SIO module.  Hands buffered input characters
+** to the processes blocked in read() on a port, and awakens those
+** whose reads are complete.
+*/
+
+static void _sio_rx_work( uint32 port ) {
+    SioPort *p = &_ports[ port ];
+    uint32 flags = __get_flags();
     Pcb *pcb;
-    int eir, lsr, msr;
-    int ch;
 
-    //
-    // Must process all pending events; loop until the EIR
-    // says there's nothing else to do.
-    //
+    __cli();
 
-    for(;;) {
+    p->rx_deferred = false;
 
-        // get the "pending event" indicator
-        eir = __inb( UA4_EIR ) & UA4_EIR_INT_PRI_MASK;
+    while( (pcb = (Pcb *) _queue_front(p->reading)) != NULL ) {
 
-        // process this event
-        switch( eir ) {
+        // a new reader starts its timer now
+        if( pcb != p->rd_pcb ) {
+            p->rd_pcb = pcb;
+            p->rd_got = 0;
+            p->rd_last = _system_time;
+        }
 
-        case UA4_EIR_LINE_STATUS_INT_PENDING:
-            // shouldn't happen, but just in case....
-            lsr = __inb( UA4_LSR );
-            __cio_printf( "** SIO line status, LSR = %02x\n", lsr );
+        // buffer is arg #2, its length arg #3
+        if( !_sio_gather(p, (char *) ARG(pcb,2), ARG(pcb,3)) ) {
             break;
+        }
 
-        case UA4_EIR_RX_INT_PENDING:
-            // get the character
-            ch = __inb( UA4_RXD );
-            if( ch == '\r' ) {    // map CR to LF
-                ch = '\n';
-            }
+        // done; return the count in EAX
+        _queue_deque( p->reading );
+        RET(pcb) = p->rd_got;
+        p->rd_pcb = NULL;
+        _schedule( pcb );
+    }
 
-            //
-            // If there is a waiting process, this must be
-            // the first input character; give it to that
-            // process and awaken the process.
-            //
+    __set_flags( flags );
+}
 
-            if( _queue_length(_reading) > 0 ) {
+/*
+** _sio_cook(p,buf,n)
+**
+** Add received characters to the input buffer of a cooked port,
+** mapping CR to LF and echoing them if the port asks for that.
+*/
 
-        pcb = (Pcb *) _queue_deque( _reading );
-        assert( pcb );
+static void _sio_cook( SioPort *p, const uint8 *buf, uint32 n ) {
+    bool echo = p->mode == SIO_MODE_ECHO;
 
-                // return char via arg #2 and count in EAX
-        char *buf = (char *) ARG(pcb,2);
-        *buf = ch & 0xff;
-                RET(pcb) = 1;
-                _schedule( pcb );
+    for( uint32 i = 0; i < n; ++i ) {
+        int ch = buf[i];
 
-            } else {
+        if( ch == '\r' ) {    // map CR to LF
+            ch = '\n';
+        }
 
-                //
-                // Nobody waiting - add to the input buffer
-                // if there is room, otherwise just ignore it.
-                //
+        //
+        // Add it to the input buffer if there is room,
+        // otherwise just ignore it.
+        //
 
-                if( _incount < BUF_SIZE ) {
-                    *_inlast++ = ch;
-                    ++_incount;
-                }
+        if( !__ring_put(&p->in, ch) ) {
+            ++p->rx_dropped;
+            continue;
+        }
 
+        // interrupts are off, so we can add to the output buffer
+        if( echo ) {
+            if( ch == '\n' ) {
+                (void) __ring_put( &p->out, '\r' );
             }
-            break;
+            (void) __ring_put( &p->out, ch );
+        }
+    }
+
+    if( echo ) {
+        _sio_enable( PORTNUM(p), SIO_TX );
+    }
+}
+
+/*
+** _sio_rx_drain(p,avail)
+**
+** Read characters until the port's receive FIFO is empty, and arrange
+** for them to be handed to any waiting processes.  The caller knows
+** that at least 'avail' characters are waiting; those are read without
+** checking the line status first.
+*/
+
+static void _sio_rx_drain( SioPort *p, uint32 avail ) {
+    uint8 burst[ RX_FIFO_SIZE ];
+    uint32 n;
+
+    ++p->rx_ints;
+
+    do {
+
+        for( n = 0; n < avail; ++n ) {
+            burst[n] = __inb( PORT(p,UA4_RXD) );
+        }
+        avail = 0;
+
+        while( n < RX_FIFO_SIZE && (__inb(PORT(p,UA4_LSR)) & UA4_LSR_RXDA) ) {
+            burst[n++] = __inb( PORT(p,UA4_RXD) );
+        }
+        p->rx_bytes += n;
+
+        //
+        // Raw characters are copied in as a block; whatever
+        // doesn't fit is lost.
+        //
+
+        if( p->mode == SIO_MODE_RAW ) {
+            p->rx_dropped += n - __ring_write( &p->in, burst, n );
+        } else {
+            _sio_cook( p, burst, n );
+        }
+
+    } while( n == RX_FIFO_SIZE );
+
+    //
+    // If there is a waiting process, arrange for it
+    // to be given the input and awakened.
+    //
+
+    if( _queue_length(p->reading) > 0 && !p->rx_deferred ) {
+        p->rx_deferred = true;
+        _kthread_defer( _sio_rx_work, PORTNUM(p) );
+    }
+}
 
-        case UA5_EIR_RX_FIFO_TIMEOUT_INT_PENDING:
-            // shouldn't happen, but just in case....
-            ch = __inb( UA4_RXD );
-            __cio_printf( "** SIO FIFO timeout, RXD = %02x\n", ch );
+/*
+** _sio_tx_work(port)
+**
+** Deferred work for the SIO module.  Copies the buffers of processes
+** blocked in write() on a port into its output buffer, and awakens
+** those whose buffers have been completely accepted.
+*/
+
+static void _sio_tx_work( uint32 port ) {
+    SioPort *p = &_ports[ port ];
+    uint32 flags = __get_flags();
+    Pcb *pcb;
+
+    __cli();
+
+    p->tx_deferred = false;
+
+    while( (pcb = (Pcb *) _queue_front(p->writing)) != NULL ) {
+        // buffer is arg #2, its length arg #3
+        const char *buf = (const char *) ARG(pcb,2);
+        uint32 length = ARG(pcb,3);
+
+        if( pcb != p->wr_pcb ) {
+            p->wr_pcb = pcb;
+            p->wr_done = 0;
+        }
+
+        p->wr_done += __ring_write( &p->out, buf + p->wr_done,
+                                    length - p->wr_done );
+        _sio_enable( port, SIO_TX );
+
+        if( p->wr_done < length ) {
             break;
+        }
+
+        // done; return the count in EAX
+        _queue_deque( p->writing );
+        RET(pcb) = p->wr_done;
+        p->wr_pcb = NULL;
+        _schedule( pcb );
+    }
+
+    __set_flags( flags );
+}
+
+/*
+** _sio_tx_fill(p)
+**
+** Refill the port's (empty) transmitter from its output buffer, or end
+** the transmit sequence if there is nothing more to send.
+*/
+
+static void _sio_tx_fill( SioPort *p ) {
+    char burst[ TX_FIFO_SIZE ];
+    uint32 n;
+
+    ++p->tx_ints;
+
+    n = __ring_read( &p->out, burst, p->tx_burst );
+
+    // once there's enough room, let blocked writers continue
+    if( !p->tx_deferred && _queue_length(p->writing) > 0 &&
+            __ring_space(&p->out) >= OBUF_LOW_WATER ) {
+        p->tx_deferred = true;
+        _kthread_defer( _sio_tx_work, PORTNUM(p) );
+    }
+
+    if( n == 0 ) {
+        // no more data - disable TX interrupts
+        _sio_disable( PORTNUM(p), SIO_TX );
+        return;
+    }
+
+    for( uint32 i = 0; i < n; ++i ) {
+        __outb( PORT(p,UA4_TXD), burst[i] );
+    }
+    p->tx_bytes += n;
+}
+
+/*
+** _sio_service(p)
+**
+** Handle the highest-priority pending event on a port.
+**
+** returns false if the port had nothing pending
+*/
+
+static bool _sio_service( SioPort *p ) {
+    int eir, lsr, msr;
+
+    // get the "pending event" indicator
+    eir = __inb( PORT(p,UA4_EIR) ) & UA4_EIR_INT_PRI_MASK;
+
+    // process this event
+    switch( eir ) {
+
+    case UA4_EIR_LINE_STATUS_INT_PENDING:
+        // shouldn't happen, but just in case....
+        lsr = __inb( PORT(p,UA4_LSR) );
+        _klog( KLOG_WARN, "COM%d line status, LSR = %02x",
+               PORTNUM(p) + 1, lsr );
+        break;
+
+    case UA4_EIR_RX_INT_PENDING:
+        // the FIFO has reached its trigger level
+        _sio_rx_drain( p, p->tx_burst > 1 ? SIO_RX_TRIG : 1 );
+        break;
+
+    case UA5_EIR_RX_FIFO_TIMEOUT_INT_PENDING:
+        // fewer characters have been waiting for a while
+        _sio_rx_drain( p, 1 );
+        break;
+
+    case UA4_EIR_TX_INT_PENDING:
+        // send more characters, if there are any
+        _sio_tx_fill( p );
+        break;
+
+    case UA4_EIR_NO_INT:
+        // nothing to do
+        return( false );
+
+    case UA4_EIR_MODEM_STATUS_INT_PENDING:
+        // shouldn't happen, but just in case....
+        msr = __inb( PORT(p,UA4_MSR) );
+        _klog( KLOG_WARN, "COM%d modem status, MSR = %02x",
+               PORTNUM(p) + 1, msr );
+        break;
+
+    default:
+        // uh-oh....
+        _klog( KLOG_ERR, "sio isr: COM%d eir %02x", PORTNUM(p) + 1,
+               ((uint32) eir) & 0xff );
+        _kpanic( "_sio_isr", "unknown device status" );
+
+    }
+
+    return( true );
+}
+
+/*
+** _sio_isr(vector,ecode)
+**
+** Interrupt handler for the SIO module.  Handles all pending
+** events on all the ports which use this vector (as described by
+** their SIO controllers).  Received characters are buffered here;
+** waking up readers is deferred to _sio_rx_work().
+*/
+
+static void _sio_isr( int vector, int ecode ) {
+    bool busy;
 
-        case UA4_EIR_TX_INT_PENDING:
-            // if there is another character, send it
-            if( _sending && _outcount > 0 ) {
-                __outb( UA4_TXD, *_outnext );
-                ++_outnext;
-                // wrap around if necessary
-                if( _outnext >= (_outbuffer + BUF_SIZE) ) {
-                    _outnext = _outbuffer;
+    //
+    // Must process all pending events on every port sharing
+    // this line; loop until a full pass finds nothing to do.
+    //
+
+    do {
+        busy = false;
+        for( int i = 0; i < SIO_PORTS; ++i ) {
+            SioPort *p = &_ports[i];
+            if( p->present && p->vector == vector ) {
+                while( _sio_service(p) ) {
+                    busy = true;
                 }
-                --_outcount;
-            } else {
-                // no more data - reset the output vars
-                _outcount = 0;
-                _outlast = _outnext = _outbuffer;
-                _sending = 0;
-                // disable TX interrupts
-                _sio_disable( SIO_TX );
             }
-            break;
+        }
+    } while( busy );
 
-        case UA4_EIR_NO_INT:
-            // nothing to do - tell the PIC we're done
-            __outb( PIC_MASTER_CMD_PORT, PIC_EOI );
-            return;
+    // let any deferred work start, then tell the PIC we're done
+    _kthread_preempt();
+    __outb( PIC_MASTER_CMD_PORT, PIC_EOI );
+}
 
-        case UA4_EIR_MODEM_STATUS_INT_PENDING:
-            // shouldn't happen, but just in case....
-            msr = __inb( UA4_MSR );
-            __cio_printf( "** SIO modem status, MSR = %02x\n", msr );
-            break;
+/*
+** _sio_probe(base)
+**
+** Look for a UART at an I/O address, using its scratch register
+** (which reads back as 0xff if nothing is there).
+*/
 
-        default:
-            // uh-oh....
-            __cio_printf( "sio isr: eir %02x\n", ((uint32) eir) & 0xff );
-            _kpanic( "_sio_isr", "unknown device status" );
+static bool _sio_probe( uint16 base ) {
+    uint16 scr = base + (UA4_UA5_SCR - UA4_PORT);
 
-        }
-    
+    __outb( scr, 0x5a );
+    if( __inb(scr) != 0x5a ) {
+        return( false );
     }
 
-    // should never reach this point!
-    assert( false );
+    __outb( scr, 0xa5 );
+    return( __inb(scr) == 0xa5 );
 }
 
 /*
-** PUBLIC FUNCTIONS
+** _sio_alloc(size)
+**
+** Allocate a buffer of 'size' bytes from the page allocator.
 */
 
+static void *_sio_alloc( uint32 size ) {
+    void *buf = _kalloc_page( (size + PAGE_SIZE - 1) / PAGE_SIZE );
+
+    assert( buf );
+    return( buf );
+}
+
 /*
-** _sio_init()
+** _sio_set_baud(p,baud)
 **
-** Initialize the UART chip.
+** Set the data rate of a port.  The caller has checked that the
+** rate is one the UART can generate.
 */
-void _sio_init( void ) {
+
+static void _sio_set_baud( SioPort *p, uint32 baud ) {
+    uint32 divisor = BAUD_CLOCK / baud;
+
+    // select bank 1 and set the divisor, then go back to bank 0
+    // with our data characteristics
+
+    __outb( PORT(p,UA4_LCR), UA4_LCR_BANK1 );
+    __outb( PORT(p,UA4_LBGD_L), BAUD_LOW_BYTE( divisor ) );
+    __outb( PORT(p,UA4_LBGD_H), BAUD_HIGH_BYTE( divisor ) );
+    __outb( PORT(p,UA4_LCR), UA4_LCR_BANK0 |
+             UA4_LCR_BITS_8 |
+             UA4_LCR_1_STOP_BIT |
+             UA4_LCR_NO_PARITY );
+
+    p->baud = baud;
+}
+
+/*
+** _sio_setup(p)
+**
+** Initialize a port, and the UART behind it.
+*/
+
+static void _sio_setup( SioPort *p ) {
 
     /*
-    ** Initialize SIO variables.
+    ** Initialize the port variables.
     */
 
-    __memset( (void *) _inbuffer, sizeof(_inbuffer), 0 );
-    _inlast = _innext = _inbuffer;
-    _incount = 0;
+    __ring_init( &p->in, _sio_alloc(BUF_SIZE), BUF_SIZE );
+    __ring_init( &p->out, _sio_alloc(SIO_OBUF_SIZE), SIO_OBUF_SIZE );
+    p->rx_deferred = p->tx_deferred = false;
+
+    p->reading = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    assert( p->reading );
+    p->writing = _queue_alloc( NULL, QOFFSET(Pcb,qlink) );
+    assert( p->writing );
 
-    __memset( (void *) _outbuffer, sizeof(_outbuffer), 0 );
-    _outlast = _outnext = _outbuffer;
-    _outcount = 0;
-    _sending = 0;
+    p->mode = SIO_MODE_COOKED;
+    p->vmin = SIO_VMIN;
+    p->vtime_ms = SIO_VTIME_MS;
+    p->vtime = MS_TO_TICKS( SIO_VTIME_MS );
+    p->rd_pcb = p->wr_pcb = NULL;
+
+    p->rx_ints = p->rx_bytes = p->rx_dropped = 0;
+    p->tx_ints = p->tx_bytes = p->tx_blocked = 0;
 
     /*
     ** Next, initialize the UART.
@@ -257,14 +696,27 @@ void _sio_init( void ) {
     ** this is a bizarre little sequence of operations
     */
 
-    __outb( UA4_FCR, 0x20 );
-    __outb( UA4_FCR, UA5_FCR_FIFO_RESET );    // 0x00
-    __outb( UA4_FCR, UA5_FCR_FIFO_EN );       // 0x01
-    __outb( UA4_FCR, UA5_FCR_FIFO_EN |
-             UA5_FCR_RXSR );                  // 0x03
-    __outb( UA4_FCR, UA5_FCR_FIFO_EN |
+    __outb( PORT(p,UA4_FCR), 0x20 );
+    __outb( PORT(p,UA4_FCR), UA5_FCR_FIFO_RESET );    // 0x00
+    __outb( PORT(p,UA4_FCR), UA5_FCR_FIFO_EN );       // 0x01
+    __outb( PORT(p,UA4_FCR), UA5_FCR_FIFO_EN |
+             UA5_FCR_RXSR );                          // 0x03
+    __outb( PORT(p,UA4_FCR), UA5_FCR_FIFO_EN |
              UA5_FCR_RXSR |
-             UA5_FCR_TXSR );                  // 0x07
+             UA5_FCR_TXSR |
+             RX_FIFO_LEVEL );                         // 0x07 | trigger
+
+    /*
+    ** Only a 16550A (or later) reports both FIFO enable bits; older
+    ** parts have no FIFOs, or FIFOs which don't work
+    */
+
+    if( (__inb(PORT(p,UA4_EIR)) & (UA5_EIR_FEN0 | UA5_EIR_FEN1)) ==
+            (UA5_EIR_FEN0 | UA5_EIR_FEN1) ) {
+        p->tx_burst = TX_FIFO_SIZE;
+    } else {
+        p->tx_burst = 1;
+    }
 
     /*
     ** disable interrupts
@@ -273,46 +725,89 @@ void _sio_init( void ) {
     ** called to switch them back on
     */
 
-    __outb( UA4_IER, 0 );
-    _ier = 0;
+    __outb( PORT(p,UA4_IER), 0 );
+    p->ier = 0;
 
     /*
-    ** select bank 1 and set the data rate
+    ** set the data rate and our data characteristics
     */
 
-    __outb( UA4_LCR, UA4_LCR_BANK1 );
-    __outb( UA4_LBGD_L, BAUD_LOW_BYTE( BAUD_9600 ) );
-    __outb( UA4_LBGD_H, BAUD_HIGH_BYTE( BAUD_9600 ) );
+    _sio_set_baud( p, SIO_BAUD );
 
-    /*
-    ** Select bank 0, and at the same time set the LCR for our
-    ** data characteristics.
-    */
-
-    __outb( UA4_LCR, UA4_LCR_BANK0 |
-             UA4_LCR_BITS_8 |
-             UA4_LCR_1_STOP_BIT |
-             UA4_LCR_NO_PARITY );
-    
     /*
     ** Set the ISEN bit to enable the interrupt request signal,
     ** and the DTR and RTS bits to enable two-way communication.
     */
 
-    __outb( UA4_MCR, UA4_MCR_ISEN | UA4_MCR_DTR | UA4_MCR_RTS );
+    __outb( PORT(p,UA4_MCR), UA4_MCR_ISEN | UA4_MCR_DTR | UA4_MCR_RTS );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+/*
+** _sio_init()
+**
+** Find and initialize the UART chips.
+*/
+void _sio_init( void ) {
+
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        SioPort *p = &_ports[i];
+
+        p->base = _sio_base[i];
+        p->vector = _sio_vector[i];
+
+        // we have always assumed there is a COM1
+        p->present = i == SIO_COM1 || _sio_probe( p->base );
+
+        if( p->present ) {
+            _sio_setup( p );
+        }
+    }
 
     /*
-    ** Install our ISR
+    ** Install our ISR on each line in use
     */
 
     __install_isr( INT_VEC_SERIAL_PORT_1, _sio_isr );
 
+    if( _ports[SIO_COM2].present || _ports[SIO_COM4].present ) {
+        __install_isr( INT_VEC_SERIAL_PORT_2, _sio_isr );
+    }
+
     /*
     ** Report that we're all set
     */
 
     __cio_puts( " SIO" );
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        if( _ports[i].present ) {
+            __cio_printf( ":%d", i + 1 );
+        }
+    }
+}
+
+/*
+** _sio_port()
+**
+** find the port for an I/O channel
+**
+** usage:    int port = _sio_port( int chan )
+**
+** returns the port number, or -1 if 'chan' is not a serial channel
+** or there is no UART for it
+*/
+
+int _sio_port( int chan ) {
+    int port = chan - CHAN_COM1;
+
+    if( port < 0 || port >= SIO_PORTS || !_ports[port].present ) {
+        return( -1 );
+    }
 
+    return( port );
 }
 
 /*
@@ -320,34 +815,39 @@ void _sio_init( void ) {
 **
 ** enable SIO interrupts
 **
-** usage:    uint8 old = _sio_enable( uint8 which )
+** usage:    uint8 old = _sio_enable( int port, uint8 which )
 **
 ** enables interrupts according to the 'which' parameter
 **
 ** returns the prior settings
 */
 
-uint8 _sio_enable( uint8 which ) {
+uint8 _sio_enable( int port, uint8 which ) {
+    SioPort *p = &_ports[ port ];
     uint8 old;
 
+    if( !p->present ) {
+        return( 0 );
+    }
+
     // remember the current status
 
-    old = _ier;
+    old = p->ier;
 
     // figure out what to enable
 
     if( which & SIO_TX ) {
-        _ier |= UA4_IER_TX_INT_ENABLE;
+        p->ier |= UA4_IER_TX_INT_ENABLE;
     }
 
     if( which & SIO_RX ) {
-        _ier |= UA4_IER_RX_INT_ENABLE;
+        p->ier |= UA4_IER_RX_INT_ENABLE;
     }
 
     // if there was a change, make it
 
-    if( old != _ier ) {
-        __outb( UA4_IER, _ier );
+    if( old != p->ier ) {
+        __outb( PORT(p,UA4_IER), p->ier );
     }
 
     // return the prior settings
@@ -360,34 +860,39 @@ uint8 _sio_enable( uint8 which ) {
 **
 ** disable SIO interrupts
 **
-** usage:    uint8 old = _sio_disable( uint8 which )
+** usage:    uint8 old = _sio_disable( int port, uint8 which )
 **
 ** disables interrupts according to the 'which' parameter
 **
 ** returns the prior settings
 */
 
-uint8 _sio_disable( uint8 which ) {
+uint8 _sio_disable( int port, uint8 which ) {
+    SioPort *p = &_ports[ port ];
     uint8 old;
 
+    if( !p->present ) {
+        return( 0 );
+    }
+
     // remember the current status
 
-    old = _ier;
+    old = p->ier;
 
     // figure out what to disable
 
     if( which & SIO_TX ) {
-        _ier &= ~UA4_IER_TX_INT_ENABLE;
+        p->ier &= ~UA4_IER_TX_INT_ENABLE;
     }
 
     if( which & SIO_RX ) {
-        _ier &= ~UA4_IER_RX_INT_ENABLE;
+        p->ier &= ~UA4_IER_RX_INT_ENABLE;
     }
 
     // if there was a change, make it
 
-    if( old != _ier ) {
-        __outb( UA4_IER, _ier );
+    if( old != p->ier ) {
+        __outb( PORT(p,UA4_IER), p->ier );
     }
 
     // return the prior settings
@@ -400,13 +905,15 @@ uint8 _sio_disable( uint8 which ) {
 **
 ** get the input queue length
 **
-** usage:    int num = _sio_input_queue()
+** usage:    int num = _sio_input_queue( int port )
 **
 ** returns the count of characters still in the input queue
 */
 
-int _sio_input_queue( void ) {
-    return( _incount );
+int _sio_input_queue( int port ) {
+    SioPort *p = &_ports[ port ];
+
+    return( p->present ? __ring_count(&p->in) : 0 );
 }
 
 /*
@@ -414,196 +921,385 @@ int _sio_input_queue( void ) {
 **
 ** get the next input character
 **
-** usage:    int ch = _sio_readc()
+** usage:    int ch = _sio_readc( int port )
 **
 ** returns the next character, or -1 if no character is available
 */
 
-int _sio_readc( void ) {
-    int ch;
+int _sio_readc( int port ) {
+    SioPort *p = &_ports[ port ];
 
-    // assume there is no character available
-    ch = -1;
+    // -1 if there is no character available
+    return( p->present ? __ring_get(&p->in) : -1 );
+}
 
-    // 
-    // If there is a character, return it
-    //
+/*
+** _sio_read(port,buf,length)
+**
+** read() for a serial channel, on behalf of the current process
+**
+** usage:    int num = _sio_read( int port, char *buffer, uint32 length )
+**
+** returns the number of bytes read, or -1 if the current process
+** has been blocked (the caller must dispatch another process)
+*/
+
+int _sio_read( int port, char *buf, uint32 length ) {
+    SioPort *p = &_ports[ port ];
+    uint32 flags;
+    int n = -1;
+
+    if( length < 1 ) {
+        return( 0 );
+    }
+
+    flags = __get_flags();
+    __cli();
+
+    if( _queue_length(p->reading) > 0 ) {
 
-    if( _incount > 0 ) {
+        // others are waiting; get in line
+        if( p->rd_pcb == _current ) {
+            p->rd_pcb = NULL;
+        }
+
+    } else {
 
-        // take it out of the input buffer
-        ch = ((int)(*_innext++)) & 0xff;
-        --_incount;
+        // take what's there; this may be enough
+        p->rd_pcb = _current;
+        p->rd_got = 0;
+        p->rd_last = _system_time;
 
-        // reset the buffer variables if this was the last one
-        if( _incount < 1 ) {
-            _inlast = _innext = _inbuffer;
+        if( _sio_gather(p, buf, length) ) {
+            n = p->rd_got;
+            p->rd_pcb = NULL;
         }
+    }
 
+    if( n < 0 ) {
+        _current->state = BLOCKED;
+        _current->queue = p->reading;
+        _queue_enque( p->reading, (void *) _current );
     }
 
-    return( ch );
+    __set_flags( flags );
 
+    return( n );
 }
 
 /*
-** _sio_reads(buf,length)
+** _sio_timer()
 **
-** read the entire input buffer into a user buffer of a specified size
+** called on each clock tick; completes the current read on each
+** port when its inter-character timeout expires
+*/
+
+void _sio_timer( void ) {
+
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        SioPort *p = &_ports[i];
+
+        if( p->rd_pcb != NULL && p->vtime != 0 && !p->rx_deferred &&
+                p->rd_got >= p->vmin &&
+                _system_time - p->rd_last >= p->vtime ) {
+            p->rx_deferred = true;
+            _kthread_defer( _sio_rx_work, i );
+        }
+    }
+}
+
+/*
+** _sio_forget(pcb)
 **
-** usage:    int num = _sio_reads( char *buffer, int length )
+** forget a process which is terminating while blocked in a read or
+** write; called after it has been removed from its queue
 **
-** returns the number of bytes copied, or 0 if no characters were available
+** usage:    _sio_forget( Pcb *pcb )
+**
+** any input already given to a reader which never completed is lost,
+** and is counted as dropped
 */
 
-int _sio_reads( char *buf, int length ) {
-    char *ptr = buf;
-    int copied = 0;
+void _sio_forget( Pcb *pcb ) {
+    uint32 flags = __get_flags();
 
-    // if there are no characters, just return 0
+    __cli();
 
-    if( _incount < 1 ) {
-        return( 0 );
-    }
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        SioPort *p = &_ports[i];
 
-    //
-    // We have characters.  Copy as many of them into the user
-    // buffer as will fit.
-    //
+        // the next reader or writer in line (if any) takes over
 
-    while( _incount > 0 && copied < length ) {
-        *ptr++ = *_innext++ & 0xff;
-        if( _innext > (_inbuffer + BUF_SIZE) ) {
-            _innext = _inbuffer;
+        if( p->rd_pcb == pcb ) {
+            p->rx_dropped += p->rd_got;
+            p->rd_pcb = NULL;
+            p->rd_got = 0;
+            if( !p->rx_deferred && _queue_length(p->reading) > 0 ) {
+                p->rx_deferred = true;
+                _kthread_defer( _sio_rx_work, i );
+            }
+        }
+
+        if( p->wr_pcb == pcb ) {
+            p->wr_pcb = NULL;
+            p->wr_done = 0;
+            if( !p->tx_deferred && _queue_length(p->writing) > 0 ) {
+                p->tx_deferred = true;
+                _kthread_defer( _sio_tx_work, i );
+            }
         }
-        --_incount;
-        ++copied;
     }
 
-    // reset the input buffer if necessary
+    __set_flags( flags );
+}
 
-    if( _incount < 1 ) {
-        _inlast = _innext = _inbuffer;
-    }
+/*
+** _sio_ioctl(port,cmd,arg)
+**
+** examine or change a serial channel setting
+**
+** usage:    int32 old = _sio_ioctl( int port, uint32 cmd, uint32 arg )
+**
+** returns the previous setting, or E_PARAM for an unknown request
+** or a bad value
+*/
 
-    // return the copy count
+int32 _sio_ioctl( int port, uint32 cmd, uint32 arg ) {
+    SioPort *p = &_ports[ port ];
+    bool set = (cmd & IOC_GET) == 0;
+    uint32 flags;
+    int32 old;
 
-    return( copied );
-}
+    switch( cmd & ~IOC_GET ) {
+
+    case IOC_SIO_VMIN:
+        old = p->vmin;
+        if( set ) {
+            p->vmin = arg;
+        }
+        break;
+
+    case IOC_SIO_VTIME:
+        old = p->vtime_ms;
+        if( set ) {
+            p->vtime_ms = arg;
+            p->vtime = MS_TO_TICKS( arg );
+        }
+        break;
 
+    case IOC_SIO_MODE:
+        old = p->mode;
+        if( set ) {
+            if( arg > SIO_MODE_ECHO ) {
+                return( E_PARAM );
+            }
+            p->mode = arg;
+        }
+        break;
+
+    case IOC_SIO_BAUD:
+        old = p->baud;
+        if( set ) {
+            // the UART can only divide down its clock
+            if( arg == 0 || arg > BAUD_CLOCK || BAUD_CLOCK % arg != 0 ) {
+                return( E_PARAM );
+            }
+            flags = __get_flags();
+            __cli();
+            _sio_set_baud( p, arg );
+            __set_flags( flags );
+        }
+        break;
+
+    default:
+        return( E_PARAM );
+    }
+
+    return( old );
+}
 
 /*
-** _sio_writec( ch )
+** _sio_reads(port,buf,length)
 **
-** write a character to the serial output
+** read the entire input buffer into a user buffer of a specified size
+**
+** usage:    int num = _sio_reads( int port, char *buffer, int length )
 **
-** usage:    _sio_writec( int ch )
+** returns the number of bytes copied, or 0 if no characters were available
 */
 
-void _sio_writec( int ch ){
+int _sio_reads( int port, char *buf, int length ) {
+    SioPort *p = &_ports[ port ];
 
+    if( !p->present || length < 1 ) {
+        return( 0 );
+    }
 
     //
-    // Must do LF -> CRLF mapping
+    // Copy as many characters into the user buffer as will fit
+    // (possibly none).
     //
 
-    if( ch == '\n' ) {
-        _sio_writec( '\r' );
+    return( __ring_read(&p->in, buf, length) );
+}
+
+
+/*
+** _sio_writec( port, ch )
+**
+** write a character to the serial output
+**
+** usage:    _sio_writec( int port, int ch )
+*/
+
+void _sio_writec( int port, int ch ){
+    SioPort *p = &_ports[ port ];
+    uint32 flags;
+
+    if( !p->present ) {
+        return;
     }
 
     //
-    // If we're currently transmitting, just add this to the buffer
+    // Must do LF -> CRLF mapping, unless the port is raw
     //
 
-    if( _sending ) {
-        *_outlast++ = ch;
-        ++_outcount;
-        return;
+    if( ch == '\n' && p->mode != SIO_MODE_RAW ) {
+        _sio_writec( port, '\r' );
     }
 
     //
-    // Not sending - must prime the pump
+    // Add this to the buffer (it's lost if there's no room), and
+    // make sure the transmitter will pick it up.  The ISR adds
+    // echoed characters, so it must be kept out meanwhile.
     //
 
-    _sending = 1;
-    __outb( UA4_TXD, ch );
+    flags = __get_flags();
+    __cli();
 
-    // Also must enable transmitter interrupts
+    (void) __ring_put( &p->out, ch );
 
-    _sio_enable( SIO_TX );
+    _sio_enable( port, SIO_TX );
 
+    __set_flags( flags );
 }
 
 /*
-** _sio_write( buffer, length )
+** _sio_write( port, buffer, length )
 **
 ** write a buffer of characters to the serial output
 **
-** usage:    int num = _sio_write( const char *buffer, int length )
+** usage:    int num = _sio_write( int port, const char *buffer, int length )
 **
 ** returns the number of characters copied into the buffer
 */
 
-int _sio_write( const char *buffer, int length ) {
-    int first = *buffer;
-    const char *ptr = buffer;
-    int copied = 0;
+int _sio_write( int port, const char *buffer, int length ) {
+    SioPort *p = &_ports[ port ];
+    uint32 flags;
+    int copied;
 
+    if( !p->present || length < 1 ) {
+        return( 0 );
+    }
 
     //
-    // If we are currently sending, we want to append all
-    // the characters to the output buffer; else, we want
-    // to append all but the first character, and then use
-    // _sio_writec() to send the first one out.
+    // Append as many of the characters to the output buffer as
+    // will fit, then make sure the transmitter will pick them up.
     //
+    // Enabling transmitter interrupts while the transmitter is
+    // idle raises an interrupt right away.  If the ISR drains the
+    // buffer and disables them between our reading and writing the
+    // IER, we just take one extra interrupt.  The ISR adds
+    // echoed characters, so it must be kept out meanwhile.
+    //
+
+    flags = __get_flags();
+    __cli();
+
+    copied = __ring_write( &p->out, buffer, length );
+
+    _sio_enable( port, SIO_TX );
+
+    __set_flags( flags );
+
+    // Return the transfer count
+
+    return( copied );
+}
+
+/*
+** _sio_write_wait( port, buffer, length )
+**
+** write() for a serial channel, on behalf of the current process
+**
+** usage:    int num = _sio_write_wait( int port, const char *buffer,
+**                                      int length )
+**
+** returns the number of characters written, or -1 if the current
+** process has been blocked until there is room for the rest (the
+** caller must dispatch another process)
+*/
+
+int _sio_write_wait( int port, const char *buffer, int length ) {
+    SioPort *p = &_ports[ port ];
+    uint32 flags;
+    int n = -1;
 
-    if( !_sending ) {
-        ptr += 1;
-        copied++;
+    if( length < 1 ) {
+        return( 0 );
     }
 
-    while( copied < length && _outcount < BUF_SIZE ) {
-        *_outlast++ = *ptr++;
-        // wrap around if necessary
-        if( _outlast >= (_outbuffer + BUF_SIZE) ) {
-            _outlast = _outbuffer;
+    flags = __get_flags();
+    __cli();
+
+    if( _queue_length(p->writing) > 0 ) {
+
+        // others are waiting; get in line
+        if( p->wr_pcb == _current ) {
+            p->wr_pcb = NULL;
         }
-        ++_outcount;
-        ++copied;
-    }
 
-    //
-    // We use _sio_writec() to send out the first character,
-    // as it will correctly set all the other necessary
-    // variables for us.
-    //
+    } else {
 
-    if( !_sending ) {
-        _sio_writec( first );
-    }
+        // take what fits; this may be all of it
+        p->wr_done = __ring_write( &p->out, buffer, length );
+        _sio_enable( port, SIO_TX );
 
-    // Return the transfer count
+        if( p->wr_done == length ) {
+            n = length;
+        } else {
+            p->wr_pcb = _current;
+        }
+    }
 
+    if( n < 0 ) {
+        ++p->tx_blocked;
+        _current->state = BLOCKED;
+        _current->queue = p->writing;
+        _queue_enque( p->writing, (void *) _current );
+    }
 
-    return( copied );
+    __set_flags( flags );
 
+    return( n );
 }
 
 /*
-** _sio_puts( buf )
+** _sio_puts( port, buf )
 **
 ** write a NUL-terminated buffer of characters to the serial output
 **
-** usage:    int num = _sio_puts( const char *buffer )
+** usage:    int num = _sio_puts( int port, const char *buffer )
 **
 ** returns the count of bytes transferred
 */
 
-int _sio_puts( const char *buffer ) {
+int _sio_puts( int port, const char *buffer ) {
     int n;  // must be outside the loop so we can return it
 
     for( n = 0; *buffer; ++n ) {
-        _sio_writec( *buffer++ );
+        _sio_writec( port, *buffer++ );
     }
 
     return( n );
@@ -618,17 +1314,19 @@ int _sio_puts( const char *buffer ) {
 */
 
 void _sio_dump( bool full ) {
-    int n;
-    char *ptr;
+    SioPort *p = &_ports[ SIO_COM1 ];
+    int n, ch;
+    uint32 incount = __ring_count( &p->in );
+    uint32 outcount = __ring_count( &p->out );
 
-    // dump basic info into the status region
+    // dump basic info about COM1 into the status region
 
     __cio_printf_at( 48, 0,
         "SIO: IER %02x (%c%c%c) in %d ot %d",
-            ((uint32)_ier) & 0xff, _sending ? '*' : '.',
-            (_ier & UA4_IER_TX_INT_ENABLE) ? 'T' : 't',
-            (_ier & UA4_IER_RX_INT_ENABLE) ? 'R' : 'r',
-            _incount, _outcount );
+            ((uint32)p->ier) & 0xff, outcount ? '*' : '.',
+            (p->ier & UA4_IER_TX_INT_ENABLE) ? 'T' : 't',
+            (p->ier & UA4_IER_RX_INT_ENABLE) ? 'R' : 'r',
+            incount, outcount );
 
     // if we're not doing a full dump, stop now
 
@@ -636,25 +1334,101 @@ void _sio_dump( bool full ) {
         return;
     }
 
-    // also want the queue contents, but we'll
+    // also want the queue contents for every port, but we'll
     // dump them into the scrolling region
 
-    if( _incount ) {
-        __cio_puts( "SIO input queue: \"" );
-        ptr = _innext; 
-        for( n = 0; n < _incount; ++n ) {
-            _put_char_or_code( *ptr++ );
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        p = &_ports[i];
+        if( !p->present ) {
+            continue;
+        }
+
+        if( __ring_count(&p->in) ) {
+            __cio_printf( "COM%d input queue: \"", i + 1 );
+            for( n = 0; (ch = __ring_peek(&p->in,n)) >= 0; ++n ) {
+                _put_char_or_code( ch );
+            }
+            __cio_puts( "\"\n" );
+        }
+
+        if( __ring_count(&p->out) ) {
+            __cio_printf( "COM%d output queue: \"", i + 1 );
+            for( n = 0; (ch = __ring_peek(&p->out,n)) >= 0; ++n )  {
+                _put_char_or_code( ch );
+            }
+            __cio_puts( "\"\n" );
+        }
+    }
+}
+
+/*
+** _sio_queue_dump()
+**
+** dump the queues of processes blocked on each port
+*/
+
+void _sio_queue_dump( void ) {
+    char msg[ 32 ];
+
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        if( _ports[i].present ) {
+            __sprint( msg, "COM%d reading queue", i + 1 );
+            _queue_dump( msg, _ports[i].reading );
+            __sprint( msg, "COM%d writing queue", i + 1 );
+            _queue_dump( msg, _ports[i].writing );
         }
-        __cio_puts( "\"\n" );
     }
+}
 
-    if( _outcount ) {
-        __cio_puts( "SIO output queue: \"" );
-        __cio_puts( " ot: \"" );
-        ptr = _outnext; 
-        for( n = 0; n < _outcount; ++n )  {
-            _put_char_or_code( *ptr++ );
+/*
+** _sio_blocked( readers, writers )
+**
+** count the processes blocked reading and writing on all ports
+*/
+
+void _sio_blocked( uint32 *readers, uint32 *writers ) {
+
+    *readers = *writers = 0;
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        if( _ports[i].present ) {
+            *readers += _queue_length( _ports[i].reading );
+            *writers += _queue_length( _ports[i].writing );
         }
-        __cio_puts( "\"\n" );
+    }
+}
+
+/*
+** _sio_stats()
+**
+** print the SIO transfer statistics for each port, with the average
+** number of bytes moved per interrupt (to two decimal places)
+*/
+
+void _sio_stats( void ) {
+
+    __cio_printf( "\nSIO: RX trigger %d, output buffer %d\n",
+                  SIO_RX_TRIG, SIO_OBUF_SIZE );
+
+    for( int i = 0; i < SIO_PORTS; ++i ) {
+        SioPort *p = &_ports[i];
+
+        if( !p->present ) {
+            continue;
+        }
+
+        __cio_printf( " COM%d: %d bps, FIFO %s, %s\n", i + 1, p->baud,
+                      p->tx_burst > 1 ? "on" : "off",
+                      p->mode == SIO_MODE_RAW ? "raw" :
+                      p->mode == SIO_MODE_ECHO ? "echo" : "cooked" );
+        __cio_printf( "  rx %d bytes %d ints (%d.%02d/int) %d dropped\n",
+                      p->rx_bytes, p->rx_ints,
+                      p->rx_ints ? p->rx_bytes / p->rx_ints : 0,
+                      p->rx_ints ? (p->rx_bytes * 100 / p->rx_ints) % 100 : 0,
+                      p->rx_dropped );
+        __cio_printf( "  tx %d bytes %d ints (%d.%02d/int) %d blocked\n",
+                      p->tx_bytes, p->tx_ints,
+                      p->tx_ints ? p->tx_bytes / p->tx_ints : 0,
+                      p->tx_ints ? (p->tx_bytes * 100 / p->tx_ints) % 100 : 0,
+                      p->tx_blocked );
     }
 }
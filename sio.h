@@ -23,6 +23,15 @@
 #define	SIO_RX		0x02
 #define	SIO_BOTH	(SIO_TX | SIO_RX)
 
+// port numbers (channel CHAN_COM1 + n is port n)
+
+#define	SIO_PORTS	4
+
+#define	SIO_COM1	0
+#define	SIO_COM2	1
+#define	SIO_COM3	2
+#define	SIO_COM4	3
+
 #ifndef __SP_ASM__
 
 #include "common.h"
@@ -43,100 +52,159 @@
 /*
 ** _sio_init()
 **
-** Initialize the UART chip.
+** Find and initialize the UART chips.
 */
 void _sio_init( void );
 
+/*
+** _sio_port()
+**
+** find the port for an I/O channel
+**
+** usage:	int port = _sio_port( int chan )
+**
+** returns the port number, or -1 if 'chan' is not a serial channel
+** or there is no UART for it
+*/
+int _sio_port( int chan );
+
 /*
 ** _sio_enable()
 **
 ** enable/disable SIO interrupts
 **
-** usage:       uint8 old = _sio_enable( uint8 which )
+** usage:       uint8 old = _sio_enable( int port, uint8 which )
 **
 ** enables interrupts according to the 'which' parameter
 **
 ** returns the prior settings
 */
-uint8 _sio_enable( uint8 which );
+uint8 _sio_enable( int port, uint8 which );
 
 /*
 ** _sio_disable()
 **
 ** disable/disable SIO interrupts
 **
-** usage:       uint8 old = _sio_disable( uint8 which )
+** usage:       uint8 old = _sio_disable( int port, uint8 which )
 **
 ** disables interrupts according to the 'which' parameter
 **
 ** returns the prior settings
 */
-uint8 _sio_disable( uint8 which );
+uint8 _sio_disable( int port, uint8 which );
 
 /*
 ** _sio_input_queue()
 **
 ** get the input queue length
 **
-** usage:	int num = _sio_input_queue()
+** usage:	int num = _sio_input_queue( int port )
 **
 ** returns the count of characters still in the input queue
 */
-int _sio_input_queue( void );
+int _sio_input_queue( int port );
 
 /*
 ** _sio_readc()
 **
 ** get the next input character
 **
-** usage:	int ch = _sio_readc()
+** usage:	int ch = _sio_readc( int port )
 **
 ** returns the next character, or -1 if no character is available
 */
-int _sio_readc( void );
+int _sio_readc( int port );
 
 /*
 ** _sio_reads()
 **
 ** get an input line, up to a specific number of characters
 **
-** usage:	int num = _sio_reads( char *buffer, length)
+** usage:	int num = _sio_reads( int port, char *buffer, length)
 **
 ** returns the number of characters put into the buffer, or 0 if no
 ** characters are available
 */
-int _sio_reads( char *buffer, int length );
+int _sio_reads( int port, char *buffer, int length );
+
+/*
+** _sio_read()
+**
+** read() for a serial channel, on behalf of the current process
+**
+** usage:	int num = _sio_read( int port, char *buffer, uint32 length )
+**
+** returns the number of characters read, or -1 if the current
+** process has been blocked on the port's reading queue (the caller
+** must dispatch another process)
+*/
+int _sio_read( int port, char *buffer, uint32 length );
+
+/*
+** _sio_timer()
+**
+** check for an expired inter-character read timeout (called by the
+** clock ISR on every tick)
+*/
+void _sio_timer( void );
+
+/*
+** _sio_ioctl()
+**
+** examine or change a serial channel setting (see IOC_SIO_* and
+** SIO_MODE_* in common.h)
+**
+** usage:	int32 old = _sio_ioctl( int port, uint32 cmd, uint32 arg )
+**
+** returns the previous setting, or an error code
+*/
+int32 _sio_ioctl( int port, uint32 cmd, uint32 arg );
 
 /*
 ** _sio_writec( ch )
 **
 ** write a character to the serial output
 **
-** usage:	_sio_writec( int ch )
+** usage:	_sio_writec( int port, int ch )
 */
-void _sio_writec( int ch );
+void _sio_writec( int port, int ch );
 
 /*
 ** _sio_write( ch )
 **
 ** write a buffer of characters to the serial output
 **
-** usage:	int num = _sio_write( const char *buffer, int length )
+** usage:	int num = _sio_write( int port, const char *buffer, int length )
 **
 ** returns the count of bytes transferred
 */
-int _sio_write( const char *buffer, int length );
+int _sio_write( int port, const char *buffer, int length );
+
+/*
+** _sio_write_wait( buffer, length )
+**
+** write() for a serial channel, on behalf of the current process
+**
+** usage:	int num = _sio_write_wait( int port, const char *buffer,
+**					   int length )
+**
+** returns the number of characters written, or -1 if the current
+** process has been blocked on the port's writing queue (the caller
+** must dispatch another process)
+*/
+int _sio_write_wait( int port, const char *buffer, int length );
 
 /*
 ** _sio_puts( buf )
 **
 ** write a NUL-terminated buffer of characters to the serial output
 **
-** usage:	n = _sio_puts( const char *buffer );
+** usage:	n = _sio_puts( int port, const char *buffer );
 **
 ** returns the count of bytes transferred
 */
-int _sio_puts( const char *buffer );
+int _sio_puts( int port, const char *buffer );
 
 /*
 ** _sio_dump( full )
@@ -145,6 +213,35 @@ int _sio_puts( const char *buffer );
 */
 void _sio_dump( bool full );
 
+/*
+** _sio_forget( pcb )
+**
+** forget a process which is terminating while blocked in a read or
+** write; called after it has been removed from its queue
+*/
+void _sio_forget( Pcb *pcb );
+
+/*
+** _sio_queue_dump()
+**
+** dump the queues of processes blocked on each port
+*/
+void _sio_queue_dump( void );
+
+/*
+** _sio_blocked( readers, writers )
+**
+** count the processes blocked reading and writing on all ports
+*/
+void _sio_blocked( uint32 *readers, uint32 *writers );
+
+/*
+** _sio_stats()
+**
+** print the SIO transfer statistics for each port
+*/
+void _sio_stats( void );
+
 #endif
 
 #endif
@@ -14,6 +14,7 @@
 
 #include "common.h"
 #include "stacks.h"
+#include "scheduler.h"
 
 /*
 ** PRIVATE DEFINITIONS
@@ -101,7 +102,12 @@ Stack *_stk_alloc( void ) {
 
         // unlink it from the list
         _free_stacks.next = new->next;
-        __memclr( new, sizeof(Stack) );
+
+        // clear it a page at a time, letting interrupts in between
+        for( uint32 i = 0; i < STACK_PAGES; ++i ) {
+            __memclr( ((uint8 *) new) + i * PAGE_SIZE, PAGE_SIZE );
+            _preempt_point();
+        }
 
     } else {
 
@@ -218,7 +218,9 @@ static void init_idt( void ){
 */
 void __panic( char *reason ){
 	__asm( "cli" );
+	__cio_show( 0 );	/* a program's screen would hide this */
 	__cio_printf( "\nPANIC: %s\nHalting...", reason );
+	__cio_flush();
 	for(;;){
 		;
 	}
@@ -258,6 +260,11 @@ void ( *__install_isr( int vector, void ( *handler )( int vector, int code ) ) )
 void __delay( int tenths ){
 	int	i;
 
+	/*
+	** The screen may not be refreshed while we wait.
+	*/
+	__cio_flush();
+
 	while( --tenths >= 0 ){
 		for( i = 0; i < 10000000; i += 1 )
 			;
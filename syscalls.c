@@ -27,12 +27,28 @@
 #include "stacks.h"
 #include "clock.h"
 #include "cio.h"
+#include "cons.h"
 #include "sio.h"
+#include "kthread.h"
+#include "irqstat.h"
+#include "cpu_features.h"
+#include "klog.h"
 
 /*
 ** PRIVATE DEFINITIONS
 */
 
+// SYSENTER support:  the MSRs
+
+#define MSR_SYSENTER_CS     0x174
+#define MSR_SYSENTER_ESP    0x175
+#define MSR_SYSENTER_EIP    0x176
+
+// console output is done in pieces of this size, with a
+// preemption point between them
+
+#define CONS_CHUNK          64
+
 /*
 ** PRIVATE DATA TYPES
 */
@@ -50,55 +66,89 @@
 
 static void (*_syscalls[N_SYSCALLS])( uint32, uint32, uint32 );
 
+///
+// system calls which may be issued through a SysRing
+//
+// only calls which can never block or exit the caller are allowed,
+// as they may be executed while the caller isn't the current process
+///
+
+static bool _batchable[N_SYSCALLS];
+
+// are we executing requests from a system call ring?
+static bool _batching;
+
 /*
 ** PUBLIC GLOBAL VARIABLES
 */
 
+// is a system call in progress?
+bool _in_syscall;
+
 /*
 ** PRIVATE FUNCTIONS
 */
 
 /*
-** _sys_isr(vector,code)
+** _ring_run(pcb)
+**
+** Execute the pending requests in the system call ring of the
+** specified process, posting a completion for each one.  Stops
+** when the submission queue is empty or the completion queue is full.
+**
+** The second-level handlers all act on _current and return their
+** results in its context, so we temporarily make the ring's owner the
+** current process, and preserve the registers the handlers overwrite.
 **
-** Common handler for the system call module.  Selects
-** the correct second-level routine to invoke based on
-** the contents of EAX.
+** @param pcb  The process whose ring is to be serviced
 **
-** The second-level routine is invoked with a pointer to
-** the PCB for the process.  It is the responsibility of
-** that routine to assign all return values for the call.
+** @returns The number of completions posted
 */
-static void _sys_isr( int vector, int code ) {
-
-    // if there is no current process, we're in deep trouble
-    assert( _current );
-
-    // much less likely to occur, but still potentially problematic
-    assert2( _current->context );
+static uint32 _ring_run( Pcb *pcb ) {
+    SysRing *ring = pcb->ring;
+    Pcb *saved = _current;
+    uint32 eax = REG(pcb,eax);
+    uint32 edx = REG(pcb,edx);
+    uint32 n = 0;
+
+    _current = pcb;
+    _batching = true;
+
+    while( ring->sq_head != ring->sq_tail &&
+           ring->cq_tail - ring->cq_head < SYSRING_SIZE ) {
+
+        SysReq *req = &ring->sq[ ring->sq_head & (SYSRING_SIZE - 1) ];
+        SysCqe *cqe = &ring->cq[ ring->cq_tail & (SYSRING_SIZE - 1) ];
+        uint32 code = req->code;
+
+        REG(pcb,edx) = 0;
+        if( code >= N_SYSCALLS || !_batchable[code] ) {
+            RET(pcb) = E_BAD_SYSCALL;
+        } else if( code == SYS_kill &&
+                   (req->args[0] == 0 || req->args[0] == pcb->pid) ) {
+            // suicide isn't a batchable operation
+            RET(pcb) = E_INVALID;
+        } else {
+            _syscalls[code]( req->args[0], req->args[1], req->args[2] );
+        }
 
-    // retrieve the arguments to the system call
-    // (even if they aren't needed)
-    uint32 arg1 = ARG(_current,1);
-    uint32 arg2 = ARG(_current,2);
-    uint32 arg3 = ARG(_current,3);
+        cqe->tag = req->tag;
+        cqe->result = (int32) RET(pcb);
+        cqe->result_hi = REG(pcb,edx);
 
-    // retrieve the code
-    uint32 syscode = REG(_current,eax);
+        ring->sq_head += 1;
+        ring->cq_tail += 1;
+        ++n;
 
-    // validate the code - if it's bad, "toodle-ooo, caribou!"
-    if( syscode >= N_SYSCALLS ) {
-        __sprint( b256, "PID %d bad syscall %d", _current->pid, syscode );
-        WARNING( b256 );
-        syscode = SYS_exit;
-        arg1 = E_BAD_SYSCALL;
+        _preempt_point();
     }
 
-    // handle the system call
-    _syscalls[syscode]( arg1, arg2, arg3 );
+    REG(pcb,eax) = eax;
+    REG(pcb,edx) = edx;
+    _current = saved;
+    _batching = false;
 
-    // tell the PIC we're done
-    __outb( PIC_MASTER_CMD_PORT, PIC_EOI );
+    return( n );
 }
 
 /*
@@ -149,7 +199,7 @@ static void _sys_kill( uint32 arg1, uint32 arg2, uint32 arg3 ) {
     
     // special case:  kill(0) --> suicide!
     if( id == 0 || id == _current->pid ) {
-        parent = _pcb_find( _current->pid );
+        parent = _pcb_find( _current->ppid );
         assert1( parent );  // shouldn't be a problem, but just in case...
         _really_exit( _current, parent, E_KILLED );
         // no current process, so we need to pick another
@@ -168,11 +218,18 @@ static void _sys_kill( uint32 arg1, uint32 arg2, uint32 arg3 ) {
 
     victim = _pcb_find( id );
 
-    if( victim == NULL ) {
+    // a zombie has already terminated, so there's nothing left to kill
+    if( victim == NULL || victim->state == ZOMBIE ) {
         RET(_current) = E_NOT_FOUND;
         return;
     }
 
+    // kernel threads are part of the system, too
+    if( IS_KTHREAD(victim) ) {
+        RET(_current) = E_INVALID;
+        return;
+    }
+
     // OK, we found the victim; how to "kill" it?  Options:
     //
     //  - change its state to KILLED, catch it and clean it up the next
@@ -251,25 +308,10 @@ static void _sys_wait( uint32 arg1, uint32 arg2, uint32 arg3 ) {
         }
 
     } else {
-        int i;
-
-        // waiting for any of our children - locate one that has exited
-        for( i = 0; i < N_PROCS; ++i ) {
-            // must be our child and must have already exited
-            if( _pcbs[i].ppid == _current->pid &&
-                _pcbs[i].state == ZOMBIE ) {
-                break;
-            }
-        }
 
-        // did we find one?
-        if( i >= N_PROCS ) {
-            // no, so we'll block
-            pcb = NULL;
-        } else {
-            // yes!
-            pcb = &_pcbs[i];
-        }
+        // waiting for any of our children - take the first one
+        // that has already exited, if there is one
+        pcb = _current->zombies;
     }
     
     // were we successful?
@@ -278,7 +320,7 @@ static void _sys_wait( uint32 arg1, uint32 arg2, uint32 arg3 ) {
         // no - we need to block
         _current->state = WAITING;
         _current->queue = _waiting;
-        assert( _queue_enque(_waiting,(void *)_current) == SUCCESS );
+        _queue_enque( _waiting, (void *) _current );
 
         // we were the current process, so we need a new one
         _dispatch();
@@ -289,6 +331,7 @@ static void _sys_wait( uint32 arg1, uint32 arg2, uint32 arg3 ) {
     // pull it from that queue
 
     assert( _queue_remove(_zombie,pcb) == pcb );
+    _pcb_list_remove( &_current->zombies, pcb );
     
     // the parent gets its PID
     RET(_current) = pcb->pid;
@@ -343,7 +386,7 @@ static void _sys_spawn( uint32 arg1, uint32 arg2, uint32 arg3 ) {
 ** implements:  int read( int chan, void *buf, uint32 len );
 */
 static void _sys_read( uint32 arg1, uint32 arg2, uint32 arg3 ) {
-    int n = 0;
+    int n = 0, port;
     int32 chan = arg1;
     char *buf = (char *) arg2;
     uint32 length = arg3;
@@ -351,43 +394,34 @@ static void _sys_read( uint32 arg1, uint32 arg2, uint32 arg3 ) {
     // try to get the next character
     switch( chan ) {
     case CHAN_CONS:
-        // console input doesn't block
-        if( __cio_input_queue() < 1 ) {
-            RET(_current) = E_NO_DATA;
+        // this may block the process; if so, we need a new one
+        n = _cons_read( buf, length );
+        if( n < 0 ) {
+            _dispatch();
             return;
         }
-        n = __cio_gets( buf, length );
-        break;
-
-    case CHAN_SIO:
-        // this may block the process; if so, _sio_reads() will dispatch
-        n = _sio_reads( buf, length );
         break;
 
     default:
-        // bad channel code!
-        RET(_current) = E_BAD_CHANNEL;
-        return;
-    }
-
-    // if there was data, return the byte count to the process;
-    // otherwise, block the process until data is available
-    if( n > 0 ) {
-
-        RET(_current) = n;
-
-    } else {
-
-        // mark it as blocked
-        _current->state = BLOCKED;
-
-        // put this process on the serial i/o input queue
-        _current->queue = _reading;
-        assert( _queue_enque(_reading,(void *)_current) == SUCCESS );
+        // must be a serial port
+        port = _sio_port( chan );
+        if( port < 0 ) {
+            // bad channel code!
+            RET(_current) = E_BAD_CHANNEL;
+            return;
+        }
 
-        // select a new current process
-        _dispatch();
+        // this may block the process; if so, we need a new one
+        n = _sio_read( port, buf, length );
+        if( n < 0 ) {
+            _dispatch();
+            return;
+        }
+        break;
     }
+
+    // return the byte count to the process
+    RET(_current) = n;
 }
 
 /*
@@ -400,23 +434,43 @@ static void _sys_write( uint32 arg1, uint32 arg2, uint32 arg3 ) {
     int chan = arg1;
     const char *buf = (const char *) arg2;
     int length = arg3;
+    int n, port;
 
     // this is almost insanely simple, but it does separate the
     // low-level device access fromm the higher-level syscall implementation
 
     switch( chan ) {
     case CHAN_CONS:
-        __cio_write( buf, length );
-        RET(_current) = length;
-        break;
-
-    case CHAN_SIO:
-        _sio_write( buf, length );
+        // write it a piece at a time, so that interrupts
+        // aren't held off for the whole string
+        for( int n = 0; n < length; n += CONS_CHUNK ) {
+            __cio_write( buf + n,
+                         length - n < CONS_CHUNK ? length - n : CONS_CHUNK );
+            _preempt_point();
+        }
         RET(_current) = length;
         break;
 
     default:
-        RET(_current) = E_BAD_CHANNEL;
+        // must be a serial port
+        port = _sio_port( chan );
+        if( port < 0 ) {
+            RET(_current) = E_BAD_CHANNEL;
+            break;
+        }
+
+        // a batched write can't block, so it gets only what fits
+        if( _batching ) {
+            n = _sio_write( port, buf, length );
+        } else {
+            // this may block the process; if so, we need a new one
+            n = _sio_write_wait( port, buf, length );
+            if( n < 0 ) {
+                _dispatch();
+                return;
+            }
+        }
+        RET(_current) = n;
         break;
     }
 }
@@ -443,17 +497,7 @@ static void _sys_sleep( uint32 arg1, uint32 arg2, uint32 arg3 ) {
     _current->wakeup = _system_time + MS_TO_TICKS(arg1);
 
     // add the current process to the sleep queue
-    if( _queue_enque(_sleeping,(void *)_current) != SUCCESS ) {
-
-        // oops - something went wrong
-        __sprint( b256, "PID %d can't put to sleep", _current->pid );
-        WARNING( b256 );
-
-        // just schedule it instead
-        _schedule( _current );
-    }
-
-    // successfully inserted, so remember where it is
+    _queue_enque( _sleeping, (void *) _current );
     _current->queue = _sleeping;
 
     // pick the next lucky contestant
@@ -533,54 +577,179 @@ static void _sys_getstate( uint32 arg1, uint32 arg2, uint32 arg3 ) {
 }
 
 /*
-** PUBLIC FUNCTIONS
+** _sys_timepage - locate the system time page
+**
+** implements:  const TimePage *timepage( void );
+**
+** returns:
+**    the address of the time page maintained by the clock ISR
+**
+** notes:
+**    - everything runs in a single address space, so the kernel's
+**      copy of the page is directly readable by the caller
 */
+static void _sys_timepage( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    RET(_current) = (uint32) _time_page;
+}
 
 /*
-** _really_exit - do the real work for exit() and some kill() calls
+** _sys_ringsetup - register (or unregister) a system call ring
 **
-** @param victim  Pointer to the PCB that should exit
-** @param parent  Pointer to the victim's parent
-** @param status  Termination status
+** implements:  int32 ringsetup( SysRing *ring );
+**
+** returns:
+**    SUCCESS, or an error code
+**
+** notes:
+**    - a NULL ring pointer unregisters the current ring
 */
-void _really_exit( Pcb *victim, Pcb *parent, int32 status ) {
-    
-    // reparent all the children of this process
-    Pid us = victim->pid;
-    int n = 0;
-    for( int i = 0; i < N_PROCS; ++i ) {
-        // if (A) this is one of this process' children, and
-        //    (B) it's an active process,
-        // hand it off to 'init'
-        if( _pcbs[i].ppid == us && _pcbs[i].state != UNUSED ) {
-            _pcbs[i].ppid = _init_pid;
-            _init_pcb->children += 1;
-            ++n;
-        }
+static void _sys_ringsetup( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    SysRing *ring = (SysRing *) arg1;
+
+    if( ((uint32) ring & MOD4_BITS) != 0 ) {
+        RET(_current) = E_PARAM;
+        return;
     }
-    
-    // verify that we found the correct number of children
-    assert1( n == victim->children );
 
-    // if we didn't panic, make sure we at least warn someone
-    if( n != victim->children ) {
-        __sprint( b256, "found %d kids, expected %d", n, victim->children );
-        WARNING( b256 );
+    _current->ring = ring;
+    RET(_current) = SUCCESS;
+}
+
+/*
+** _sys_ringenter - execute the pending requests in our system call ring
+**
+** implements:  int32 ringenter( void );
+**
+** returns:
+**    the number of completions posted, or an error code
+*/
+static void _sys_ringenter( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+
+    if( _current->ring == NULL ) {
+        RET(_current) = E_INVALID;
+        return;
     }
-    
-    // if the parent isn't currently waiting, this
-    // process becomes a zombie
-    if( parent->state != WAITING ) {
 
-        victim->state = ZOMBIE;
-        victim->queue = _zombie;
+    RET(_current) = _ring_run( _current );
+}
+
+/*
+** _sys_irqstats - retrieve interrupt statistics
+**
+** implements:  int32 irqstats( IrqInfo *buf, uint32 count );
+**
+** returns:
+**    the number of entries filled in (one for each vector which has
+**    been handled), or an error code
+**
+** notes:
+**    - without ISR_STATS, no statistics are kept and this returns 0
+*/
+static void _sys_irqstats( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    IrqInfo *buf = (IrqInfo *) arg1;
 
-        // failure to enque is a Bad Thing(tm)
-        assert( _queue_enque(_zombie,(void *)victim) == SUCCESS );
+    if( buf == NULL && arg2 > 0 ) {
+        RET(_current) = E_PARAM;
         return;
     }
-        
-    // OK, we know that the parent is currently wait()ing
+
+    RET(_current) = _irq_get( buf, arg2 );
+}
+
+/*
+** _sys_cpuinfo - retrieve the CPU identification and feature table
+**
+** implements:  int32 cpuinfo( CpuInfo *info );
+**
+** returns:
+**    SUCCESS, or an error code
+*/
+static void _sys_cpuinfo( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    CpuInfo *info = (CpuInfo *) arg1;
+
+    if( info == NULL ) {
+        RET(_current) = E_PARAM;
+        return;
+    }
+
+    *info = _cpu_info;
+    RET(_current) = SUCCESS;
+}
+
+/*
+** _sys_ioctl - examine or change a setting of an I/O channel
+**
+** implements:  int32 ioctl( int chan, uint32 cmd, uint32 arg );
+**
+** returns:
+**    the previous value of the setting, or an error code
+*/
+static void _sys_ioctl( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+
+    if( (int) arg1 == CHAN_CONS ) {
+        RET(_current) = _cons_ioctl( arg2, arg3 );
+        return;
+    }
+
+    // otherwise, it must be a serial port
+    int port = _sio_port( (int) arg1 );
+
+    if( port < 0 ) {
+        RET(_current) = E_BAD_CHANNEL;
+        return;
+    }
+
+    RET(_current) = _sio_ioctl( port, arg2, arg3 );
+}
+
+/*
+** _sys_klog - read the kernel log
+**
+** implements:  int32 klog( uint32 *seq, char *buf, uint32 length );
+**
+** returns:
+**    the number of bytes copied into the buffer, or an error code
+**
+** notes:
+**    - only whole records (lines) are copied
+**    - *seq is updated to the number of the next record to be read
+*/
+static void _sys_klog( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    uint32 *seq = (uint32 *) arg1;
+    char *buf = (char *) arg2;
+
+    if( seq == NULL || (buf == NULL && arg3 > 0) ) {
+        RET(_current) = E_PARAM;
+        return;
+    }
+
+    RET(_current) = _klog_read( seq, buf, arg3 );
+}
+
+/*
+** _sys_conmap - get a screen which can be drawn on directly
+**
+** implements:  uint16 *conmap( int32 show );
+**
+** returns:
+**    the address of the caller's screen, or NULL
+**
+** notes:
+**    - as with the time page, this is kernel memory which the caller
+**      uses directly; the console module composites it onto the
+**      display while it has the focus
+*/
+static void _sys_conmap( uint32 arg1, uint32 arg2, uint32 arg3 ) {
+    RET(_current) = (uint32) _cons_map( _current, arg1 != 0 );
+}
+
+/*
+** _deliver - hand a terminated child to its wait()ing parent
+**
+** @param parent  Pointer to the parent, which must be WAITING
+** @param victim  Pointer to the terminated child
+*/
+static void _deliver( Pcb *parent, Pcb *victim ) {
 
     // remove it from the waiting queue; if we can't, we're in trouble
     assert( _queue_remove(_waiting,parent) == parent );
@@ -589,7 +758,7 @@ void _really_exit( Pcb *victim, Pcb *parent, int32 status ) {
     RET(parent) = victim->pid;
 
     // if the parent wants it, also return the exit status
-    int32 *sval = (int32 *) ARG(parent,1);
+    int32 *sval = (int32 *) ARG(parent,2);
     if( sval != NULL ) {
         *sval = victim->exit_status;  // exit status
     }
@@ -604,16 +773,172 @@ void _really_exit( Pcb *victim, Pcb *parent, int32 status ) {
     _proc_cleanup( victim );
 }
 
+/*
+** _reparent - hand a list of children off to 'init'
+**
+** @param list  The 'kids' or 'zombies' list of an exiting process
+** @param dest  The corresponding list in init's PCB
+**
+** @returns the number of children moved
+*/
+static int _reparent( Pcb **list, Pcb **dest ) {
+    int n = 0;
+
+    while( *list != NULL ) {
+        Pcb *pcb = *list;
+        _pcb_list_remove( list, pcb );
+        _pcb_list_add( dest, pcb );
+        pcb->ppid = _init_pid;
+        _init_pcb->children += 1;
+        ++n;
+    }
+
+    return( n );
+}
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+/*
+** _sys_entry(code,arg1,arg2,arg3)
+**
+** Common handler for the system call module, called from the
+** system call entry stubs in isr_stubs.S.  Selects the correct
+** second-level routine to invoke based on the code.
+**
+** It is the responsibility of the second-level routine to assign
+** all return values for the call.
+**
+** System calls are software interrupts, so there is no PIC
+** acknowledgement to send here.
+*/
+void _sys_entry( uint32 code, uint32 arg1, uint32 arg2, uint32 arg3 ) {
+
+#ifdef ISR_STATS
+    // grab this before a nested interrupt can replace it
+    uint64 entry = _irq_entry_tsc;
+    uint64 start = __rdtsc();
+#endif
+
+    // if there is no current process, we're in deep trouble
+    assert( _current );
+
+    // much less likely to occur, but still potentially problematic
+    assert2( _current->context );
+
+    // validate the code - if it's bad, "toodle-ooo, caribou!"
+    if( code >= N_SYSCALLS ) {
+        __sprint( b256, "PID %d bad syscall %d", _current->pid, code );
+        WARNING( b256 );
+        code = SYS_exit;
+        arg1 = E_BAD_SYSCALL;
+    }
+
+    // handle the system call
+    _in_syscall = true;
+    _syscalls[code]( arg1, arg2, arg3 );
+    _in_syscall = false;
+
+#ifdef ISR_STATS
+    _irq_account( INT_VEC_SYSCALL, entry, start );
+#endif
+}
+
+/*
+** _really_exit - do the real work for exit() and some kill() calls
+**
+** @param victim  Pointer to the PCB that should exit
+** @param parent  Pointer to the victim's parent
+** @param status  Termination status
+*/
+void _really_exit( Pcb *victim, Pcb *parent, int32 status ) {
+
+    // give up the screen (and the display, if it has it)
+    _cons_unmap( victim );
+
+    // a serial port may still think it is reading or writing for us
+    _sio_forget( victim );
+    
+    // reparent all the children of this process, live or not
+    int n = _reparent( &victim->kids, &_init_pcb->kids );
+    n += _reparent( &victim->zombies, &_init_pcb->zombies );
+    
+    // verify that we found the correct number of children
+    assert1( n == victim->children );
+
+    // if we didn't panic, make sure we at least warn someone
+    if( n != victim->children ) {
+        __sprint( b256, "found %d kids, expected %d", n, victim->children );
+        WARNING( b256 );
+    }
+
+    // if init inherited a zombie while it is waiting for any child,
+    // let it have one of them now
+    if( _init_pcb->state == WAITING && ARG(_init_pcb,1) == 0 &&
+        _init_pcb->zombies != NULL ) {
+        Pcb *zombie = _init_pcb->zombies;
+        assert( _queue_remove(_zombie,zombie) == zombie );
+        _pcb_list_remove( &_init_pcb->zombies, zombie );
+        _deliver( _init_pcb, zombie );
+    }
+
+    // the victim is no longer one of its parent's live children
+    _pcb_list_remove( &parent->kids, victim );
+    
+    // if the parent isn't currently waiting for this process
+    // (or for any child), this process becomes a zombie
+    Pid target = (Pid) ARG(parent,1);
+    if( parent->state != WAITING ||
+        (target != 0 && target != victim->pid) ) {
+
+        victim->state = ZOMBIE;
+        victim->queue = _zombie;
+        _pcb_list_add( &parent->zombies, victim );
+        _queue_enque( _zombie, (void *) victim );
+        return;
+    }
+        
+    // OK, we know that the parent is currently wait()ing for us
+    _deliver( parent, victim );
+}
+
+/*
+** _sys_ring_poll - service the system call rings of polling processes
+**
+** Called when there is nothing else for the CPU to do
+**
+** Owners blocked in wait(), read() or write() are skipped: the result
+** of that call is placed in their context when it completes, possibly
+** by one of the queued requests (e.g., killing a child being waited
+** for), and _ring_run() would then overwrite it with the registers it
+** preserved.  Sleeping owners are safe, as sleep() returns nothing.
+*/
+void _sys_ring_poll( void ) {
+
+    for( Pcb *pcb = _pcb_first(); pcb != NULL; pcb = _pcb_next(pcb) ) {
+        if( pcb->state == ZOMBIE || pcb->state == WAITING ||
+            pcb->state == BLOCKED ) {
+            continue;
+        }
+        if( pcb->ring != NULL && (pcb->ring->flags & SYSRING_POLL) != 0 ) {
+            (void) _ring_run( pcb );
+        }
+    }
+}
+
 /*
 ** _sys_init()
 **
 ** initialize the syscall module
 **
 ** MUST BE CALLED AFTER THE _sio_init FUNCTION HAS BEEN CALLED,
-** SO THAT THE _reading QUEUE HAS BEEN CREATED.
+** SO THAT THE SERIAL PORTS HAVE BEEN SET UP.
 */
 void _sys_init( void ) {
 
+    _in_syscall = false;
+
     ///
     // Set up the syscall jump table.  We do this here
     // to ensure that the association between syscall
@@ -632,9 +957,40 @@ void _sys_init( void ) {
     _syscalls[ SYS_getpid ]    = _sys_getpid;
     _syscalls[ SYS_getppid ]   = _sys_getppid;
     _syscalls[ SYS_getstate ]  = _sys_getstate;
-
-    // install the second-stage ISR
-    __install_isr( INT_VEC_SYSCALL, _sys_isr );
+    _syscalls[ SYS_timepage ]  = _sys_timepage;
+    _syscalls[ SYS_ringsetup ] = _sys_ringsetup;
+    _syscalls[ SYS_ringenter ] = _sys_ringenter;
+    _syscalls[ SYS_irqstats ]  = _sys_irqstats;
+    _syscalls[ SYS_cpuinfo ]   = _sys_cpuinfo;
+    _syscalls[ SYS_ioctl ]     = _sys_ioctl;
+    _syscalls[ SYS_klog ]      = _sys_klog;
+    _syscalls[ SYS_conmap ]    = _sys_conmap;
+
+    _batchable[ SYS_kill ]     = true;
+    _batchable[ SYS_spawn ]    = true;
+    _batchable[ SYS_write ]    = true;
+    _batchable[ SYS_gettime ]  = true;
+    _batchable[ SYS_getpid ]   = true;
+    _batchable[ SYS_getppid ]  = true;
+    _batchable[ SYS_getstate ] = true;
+    _batchable[ SYS_timepage ] = true;
+    _batchable[ SYS_cpuinfo ]  = true;
+    _batchable[ SYS_ioctl ]    = true;
+    _batchable[ SYS_klog ]     = true;
+    _batchable[ SYS_conmap ]   = true;
+
+    // The INT_VEC_SYSCALL entry in the IDT is set up by isr_stubs.S.
+    // If this CPU has a usable SYSENTER instruction, also point the
+    // SYSENTER MSRs at our entry stub, and tell the user library (which
+    // checks the time page; see ulibs.S) that it may use SYSENTER.
+
+    if( _cpu_has(CPU_SEP) ) {
+        extern void __isr_sysenter( void );
+        __wrmsr( MSR_SYSENTER_CS, GDT_CODE );
+        __wrmsr( MSR_SYSENTER_ESP, (uint32) _system_esp );
+        __wrmsr( MSR_SYSENTER_EIP, (uint32) __isr_sysenter );
+        _time_page->flags |= TP_SYSENTER;
+    }
 
     // report that we made it this far
     __cio_puts( " SYSCALL" );
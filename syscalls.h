@@ -34,9 +34,17 @@
 #define	SYS_getpid	8
 #define	SYS_getppid	9
 #define	SYS_getstate	10
+#define	SYS_timepage	11
+#define	SYS_ringsetup	12
+#define	SYS_ringenter	13
+#define	SYS_irqstats	14
+#define	SYS_cpuinfo	15
+#define	SYS_ioctl	16
+#define	SYS_klog	17
+#define	SYS_conmap	18
 
 // UPDATE THIS DEFINITION IF MORE SYSCALLS ARE ADDED!
-#define	N_SYSCALLS	11
+#define	N_SYSCALLS	19
 
 // dummy system call code to test our ISR
 
@@ -46,6 +54,13 @@
 
 #define	INT_VEC_SYSCALL		0x42
 
+// time page (SYS_timepage) flags, and the byte offset of the
+// 'flags' field for assembly language code (see Offsets.c)
+
+#define	TP_SYSENTER		0x01	// the kernel accepts SYSENTER
+
+#define	TP_FLAGS_OFFSET		24
+
 #ifdef	__SP_KERNEL__
 
 // the following declarations should only be seen by the kernel
@@ -67,10 +82,25 @@
 ** Globals
 */
 
+// is a system call in progress?
+extern bool _in_syscall;
+
 /*
 ** Prototypes
 */
 
+/*
+** _sys_entry - common entry point for all system calls
+**
+** Called from the system call stubs in isr_stubs.S
+**
+** @param code  The system call code (from EAX)
+** @param arg1  First argument (from EBX)
+** @param arg2  Second argument (from EDX)
+** @param arg3  Third argument (from ECX)
+*/
+void _sys_entry( uint32 code, uint32 arg1, uint32 arg2, uint32 arg3 );
+
 /*
 ** _really_exit - do the real work for exit() and some kill() calls
 **
@@ -80,6 +110,13 @@
 */
 void _really_exit( Pcb *victim, Pcb *parent, int32 status );
 
+/*
+** _sys_ring_poll - service the system call rings of polling processes
+**
+** Called when there is nothing else for the CPU to do
+*/
+void _sys_ring_poll( void );
+
 /*
 ** _sys_init()
 **
@@ -63,6 +63,141 @@ typedef uint16 Pid;
 
 typedef uint64 Time;
 
+// The time page, published by the clock module and read directly by
+// user code (see fast_gettime()).  The kernel makes 'seq' odd while
+// it is updating the page; readers must retry if they see an odd
+// value, or if 'seq' changes while they are reading the other fields.
+// 'flags' is set once, during system initialization.
+typedef struct timepage_s {
+    volatile uint32 seq;           // update sequence counter
+    volatile uint32 tsc_per_tick;  // TSC cycles per clock tick, or 0
+    volatile Time time;            // system time at the last tick
+    volatile uint64 tsc;           // TSC value at the last tick
+    volatile uint32 flags;         // TP_* flags (see syscalls.h)
+} TimePage;
+
+// Batched system call rings (see ringsetup() and ringenter())
+//
+// The process fills in requests at sq[sq_tail % SYSRING_SIZE] and then
+// advances sq_tail; the kernel consumes requests from sq_head, and posts
+// a completion for each at cq[cq_tail % SYSRING_SIZE].  The process
+// consumes completions from cq_head.  All four indices increase without
+// bound (modulo 2^32).
+
+#define SYSRING_SIZE    32      // entries per ring (must be a power of 2)
+
+#define SYSRING_POLL    0x01    // kernel polls the ring when it is idle
+
+typedef struct sysreq_s {
+    uint32 code;                // system call code
+    uint32 args[3];             // system call arguments
+    uint32 tag;                 // copied into the completion
+} SysReq;
+
+typedef struct syscqe_s {
+    uint32 tag;                 // tag from the request
+    int32 result;               // return value (EAX)
+    uint32 result_hi;           // upper half of a Time result (EDX)
+} SysCqe;
+
+typedef struct sysring_s {
+    uint32 flags;               // SYSRING_* flags
+    volatile uint32 sq_head;    // next request the kernel will take
+    volatile uint32 sq_tail;    // next free request slot
+    volatile uint32 cq_head;    // next completion the process will take
+    volatile uint32 cq_tail;    // next free completion slot
+    SysReq sq[SYSRING_SIZE];    // submission queue
+    SysCqe cq[SYSRING_SIZE];    // completion queue
+} SysRing;
+
+// Interrupt statistics for one vector (see irqstats())
+//
+// hist[0] counts entries where the handler was called within 64 cycles
+// of entry to the stub; hist[n] counts delays of 2^(n+5) to 2^(n+6)-1
+// cycles, and the last bucket counts everything longer.
+
+#define IRQ_HIST_SIZE   16      // histogram buckets
+
+typedef struct irqinfo_s {
+    uint32 vector;              // interrupt vector
+    uint32 count;               // number of times handled
+    uint64 cycles;              // total TSC cycles spent in the handler
+    uint32 max;                 // longest single handler run, in cycles
+    uint32 hist[IRQ_HIST_SIZE]; // entry-to-handler delay histogram
+} IrqInfo;
+
+// CPU features (see cpuinfo())
+//
+// Each feature is identified by its position in the 'words' array of a
+// CpuInfo: bit (f & 31) of words[f >> 5].  The words hold the feature
+// registers returned by CPUID, as listed below.
+
+#define CPU_WORD_1_EDX      0       // leaf 1, EDX
+#define CPU_WORD_1_ECX      1       // leaf 1, ECX
+#define CPU_WORD_7_EBX      2       // leaf 7 (subleaf 0), EBX
+#define CPU_WORD_7_ECX      3       // leaf 7 (subleaf 0), ECX
+#define CPU_WORD_X1_EDX     4       // leaf 0x80000001, EDX
+#define CPU_WORD_X1_ECX     5       // leaf 0x80000001, ECX
+#define CPU_WORD_X7_EDX     6       // leaf 0x80000007, EDX
+#define CPU_NWORDS          7
+
+#define CPU_FEATURE(w,b)    ((w) * 32 + (b))
+
+#define CPU_FPU         CPU_FEATURE(CPU_WORD_1_EDX, 0)
+#define CPU_PSE         CPU_FEATURE(CPU_WORD_1_EDX, 3)
+#define CPU_TSC         CPU_FEATURE(CPU_WORD_1_EDX, 4)
+#define CPU_MSR         CPU_FEATURE(CPU_WORD_1_EDX, 5)
+#define CPU_APIC        CPU_FEATURE(CPU_WORD_1_EDX, 9)
+#define CPU_SEP         CPU_FEATURE(CPU_WORD_1_EDX, 11)
+#define CPU_PGE         CPU_FEATURE(CPU_WORD_1_EDX, 13)
+#define CPU_CMOV        CPU_FEATURE(CPU_WORD_1_EDX, 15)
+#define CPU_CLFLUSH     CPU_FEATURE(CPU_WORD_1_EDX, 19)
+#define CPU_MMX         CPU_FEATURE(CPU_WORD_1_EDX, 23)
+#define CPU_FXSR        CPU_FEATURE(CPU_WORD_1_EDX, 24)
+#define CPU_SSE         CPU_FEATURE(CPU_WORD_1_EDX, 25)
+#define CPU_SSE2        CPU_FEATURE(CPU_WORD_1_EDX, 26)
+#define CPU_HTT         CPU_FEATURE(CPU_WORD_1_EDX, 28)
+
+#define CPU_SSE3        CPU_FEATURE(CPU_WORD_1_ECX, 0)
+#define CPU_PCLMUL      CPU_FEATURE(CPU_WORD_1_ECX, 1)
+#define CPU_MWAIT       CPU_FEATURE(CPU_WORD_1_ECX, 3)
+#define CPU_SSSE3       CPU_FEATURE(CPU_WORD_1_ECX, 9)
+#define CPU_SSE41       CPU_FEATURE(CPU_WORD_1_ECX, 19)
+#define CPU_SSE42       CPU_FEATURE(CPU_WORD_1_ECX, 20)
+#define CPU_X2APIC      CPU_FEATURE(CPU_WORD_1_ECX, 21)
+#define CPU_POPCNT      CPU_FEATURE(CPU_WORD_1_ECX, 23)
+#define CPU_XSAVE       CPU_FEATURE(CPU_WORD_1_ECX, 26)
+#define CPU_AVX         CPU_FEATURE(CPU_WORD_1_ECX, 28)
+#define CPU_RDRAND      CPU_FEATURE(CPU_WORD_1_ECX, 30)
+#define CPU_HYPERVISOR  CPU_FEATURE(CPU_WORD_1_ECX, 31)
+
+#define CPU_BMI1        CPU_FEATURE(CPU_WORD_7_EBX, 3)
+#define CPU_AVX2        CPU_FEATURE(CPU_WORD_7_EBX, 5)
+#define CPU_SMEP        CPU_FEATURE(CPU_WORD_7_EBX, 7)
+#define CPU_BMI2        CPU_FEATURE(CPU_WORD_7_EBX, 8)
+#define CPU_ERMS        CPU_FEATURE(CPU_WORD_7_EBX, 9)
+#define CPU_RDSEED      CPU_FEATURE(CPU_WORD_7_EBX, 18)
+
+#define CPU_NX          CPU_FEATURE(CPU_WORD_X1_EDX, 20)
+#define CPU_RDTSCP      CPU_FEATURE(CPU_WORD_X1_EDX, 27)
+#define CPU_LM          CPU_FEATURE(CPU_WORD_X1_EDX, 29)
+
+#define CPU_LZCNT       CPU_FEATURE(CPU_WORD_X1_ECX, 5)
+
+#define CPU_INVTSC      CPU_FEATURE(CPU_WORD_X7_EDX, 8)
+
+#define CPU_HAS(info,f) (((info)->words[(f) >> 5] >> ((f) & 31)) & 1)
+
+typedef struct cpuinfo_s {
+    char vendor[16];            // vendor string (NUL-terminated)
+    uint32 family;              // display family
+    uint32 model;               // display model
+    uint32 stepping;
+    uint32 max_leaf;            // highest standard CPUID leaf
+    uint32 max_ext_leaf;        // highest extended CPUID leaf
+    uint32 words[CPU_NWORDS];   // feature registers
+} CpuInfo;
+
 // a Status type and its values
 
 typedef int Status;
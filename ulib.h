@@ -107,6 +107,11 @@ int32 spawn( int (*entry)(int,char*), char *args[] );
 ** @param length Maximum capacity of the buffer
 **
 ** @returns      The count of bytes transferred, or an error code
+**
+** A read blocks until there is input for it.  Console input is read
+** a line at a time (at most one line per read, ending with a newline;
+** 0 is returned for ^D on an empty line) unless the console has been
+** switched to raw mode with ioctl(CHAN_CONS,IOC_CONS_MODE,CONS_MODE_RAW).
 */
 int32 read( int chan, void *buffer, uint32 length );
 
@@ -120,6 +125,11 @@ int32 read( int chan, void *buffer, uint32 length );
 ** @param size   Number of bytes to write
 **
 ** @returns      The count of bytes transferred, or an error code
+**
+** A write to a serial channel (CHAN_COM1 through CHAN_COM4; CHAN_SIO
+** is COM1) blocks until the whole buffer has been accepted into the
+** output buffer; one queued with ringenter() instead transfers only
+** as much as fits.
 */
 int32 write( int chan, const void *buf, uint32 length );
 
@@ -170,6 +180,128 @@ Pid getppid( void );
 */
 State getstate( uint16 pid );
 
+/*
+** timepage - locate the system time page
+**
+** usage:	tp = timepage();
+**
+** @returns A pointer to the (read-only) time page
+**
+** Most programs should use fast_gettime() rather than reading
+** the time page directly.
+*/
+const TimePage *timepage( void );
+
+/*
+** ringsetup - register a batched system call ring
+**
+** usage:	n = ringsetup(ring);
+**
+** @param ring The ring to use, or NULL to unregister the current ring
+**
+** @returns 0 on success, else an error code
+**
+** The ring must remain valid until it is unregistered or the process
+** exits.  If SYSRING_POLL is set in its flags, the kernel will also
+** service the ring whenever it has nothing else to do, except while
+** the process is blocked in wait(), read() or write().
+*/
+int32 ringsetup( SysRing *ring );
+
+/*
+** ringenter - execute the requests queued in our system call ring
+**
+** usage:	n = ringenter();
+**
+** @returns The number of completions posted, or an error code
+**
+** Only system calls which cannot block may be queued (kill, spawn,
+** write, gettime, getpid, getppid, getstate, timepage, cpuinfo,
+** ioctl, klog, conmap); any other code completes with E_BAD_SYSCALL.
+*/
+int32 ringenter( void );
+
+/*
+** irqstats - retrieve per-vector interrupt statistics
+**
+** usage:	n = irqstats(buf,count);
+**
+** @param buf   Array to be filled in
+** @param count Number of entries in 'buf'
+**
+** @returns The number of entries filled in, or an error code
+**
+** One entry is returned for each vector which has been handled.  The
+** kernel only keeps these statistics when built with ISR_STATS.
+*/
+int32 irqstats( IrqInfo *buf, uint32 count );
+
+/*
+** cpuinfo - retrieve the CPU identification and feature table
+**
+** usage:	n = cpuinfo(&info);
+**
+** @param info Where to put the information
+**
+** @returns SUCCESS, or an error code
+**
+** Use CPU_HAS(&info,CPU_xxx) to test for individual features.
+*/
+int32 cpuinfo( CpuInfo *info );
+
+/*
+** ioctl - examine or change a setting of an I/O channel
+**
+** usage:	old = ioctl(chan,cmd,arg);
+**
+** @param chan  CHAN_CONS, or a serial channel (CHAN_COM1 through CHAN_COM4)
+** @param cmd   Which setting (IOC_CONS_* or IOC_SIO_*), possibly ORed
+**              with IOC_GET
+** @param arg   The new value (ignored with IOC_GET)
+**
+** @returns The previous value of the setting, or an error code
+*/
+int32 ioctl( int chan, uint32 cmd, uint32 arg );
+
+/*
+** klog - read the kernel log
+**
+** usage:	n = klog(&seq,buf,length);
+**
+** @param seq    Number of the first record wanted (0 for the oldest
+**               one still kept); updated to the number of the next one
+** @param buf    Where to put the records
+** @param length Size of 'buf'
+**
+** @returns The number of bytes put into 'buf', or an error code
+**
+** Each record is one line of text, "[seconds.ms] L message", where L
+** is E, W, I or D (error, warning, information, debug).  Only whole
+** lines are copied; 0 is returned when there are no more records.
+*/
+int32 klog( uint32 *seq, char *buf, uint32 length );
+
+/*
+** conmap - get a screen which can be drawn on directly
+**
+** usage:	screen = conmap(show);
+**
+** @param show  Non-zero to have the display show the screen, zero to
+**              give the display back to the console
+**
+** @returns The screen (CONS_ROWS lines of CONS_COLS cells), or NULL if
+**          there was no memory for one
+**
+** Each cell holds a character in its low byte and its attribute
+** (colors) in the high byte.  The screen is blank when first obtained,
+** and is kept until the process exits.  While it is shown, the changed
+** cells appear on the display at the next console refresh, and console
+** output is saved until the console is shown again (after conmap(0),
+** the exit of the process, or the start of the kernel shell).  Only
+** one process' screen is shown at a time.
+*/
+uint16 *conmap( int32 show );
+
 /*
 ** bogus - a bogus system call, for testing our syscall ISR
 **
@@ -307,6 +439,32 @@ char *strcat( register char *dst, register const char *src );
 */
 int strcmp( register const char *s1, register const char *s2 );
 
+/*
+** memcopy(dst,src,len) - copy a block of memory
+**
+** @param dst The destination buffer
+** @param src The source buffer
+** @param len Number of bytes to copy
+**
+** Uses SSE2 for large blocks when the CPU has it.  (This isn't called
+** memcpy() so that any call the compiler generates in kernel code can
+** never reach the SSE2 version.)
+**
+** NOTE:  may not correctly deal with overlapping buffers
+*/
+void memcopy( void *dst, const void *src, uint32 len );
+
+/*
+** memfill(buf,len,value) - set all bytes of a block of memory
+**
+** @param buf   The buffer
+** @param len   Number of bytes to set
+** @param value The value to store in each byte
+**
+** Uses SSE2 for large blocks when the CPU has it.
+*/
+void memfill( void *buf, uint32 len, uint32 value );
+
 /*
 ** pad(dst,extra,padchar) - generate a padding string
 **
@@ -361,6 +519,50 @@ void sprint( char *dst, char *fmt, ... );
 **********************************************
 */
 
+/*
+** fast_gettime() - retrieve the current system time without a syscall
+**
+** @returns The current system time
+**
+** Reads the time page published by the clock ISR; only the first
+** call (which locates the page) traps into the kernel.
+*/
+Time fast_gettime( void );
+
+/*
+** rdtsc() - read the processor time-stamp counter
+**
+** @returns The current TSC value
+*/
+uint64 rdtsc( void );
+
+/*
+** ring_submit(ring,code,a1,a2,a3,tag) - queue a request in a system
+**                                       call ring
+**
+** @param ring The ring
+** @param code The system call code (SYS_xxx, from syscalls.h)
+** @param a1   First argument
+** @param a2   Second argument
+** @param a3   Third argument
+** @param tag  Value to be returned in the completion
+**
+** @returns 0 on success, or E_SPACE if the submission queue is full
+*/
+int32 ring_submit( SysRing *ring, uint32 code, uint32 a1, uint32 a2,
+                   uint32 a3, uint32 tag );
+
+/*
+** ring_reap(ring,cqe) - retrieve the next completion from a system
+**                       call ring
+**
+** @param ring The ring
+** @param cqe  Where to place the completion
+**
+** @returns true if a completion was retrieved, else false
+*/
+bool ring_reap( SysRing *ring, SysCqe *cqe );
+
 /*
 ** exit_helper()
 **
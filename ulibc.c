@@ -11,6 +11,7 @@
 */
 
 #include "common.h"
+#include "wstring.h"
 
 /*
 ** PRIVATE DEFINITIONS
@@ -24,6 +25,28 @@
 ** PRIVATE GLOBAL VARIABLES
 */
 
+// location of the system time page (found on first use)
+
+static const TimePage *_timepage;
+
+// block memory routines (see ulibs.S)
+
+extern void __memcopy_rep( void *dst, const void *src, uint32 len );
+extern void __memcopy_sse2( void *dst, const void *src, uint32 len );
+extern void __memfill_rep( void *buf, uint32 len, uint32 value );
+extern void __memfill_sse2( void *buf, uint32 len, uint32 value );
+
+static void _mem_choose( void );
+
+static void _memcopy_first( void *dst, const void *src, uint32 len );
+static void _memfill_first( void *buf, uint32 len, uint32 value );
+
+// the selected implementations; these are shared by all processes,
+// which all run on the same CPU
+
+static void (*_memcopy_impl)( void *, const void *, uint32 ) = _memcopy_first;
+static void (*_memfill_impl)( void *, uint32, uint32 ) = _memfill_first;
+
 /*
 ** PUBLIC GLOBAL VARIABLES
 */
@@ -32,6 +55,36 @@
 ** PRIVATE FUNCTIONS
 */
 
+/*
+** _mem_choose() - select the block memory routines for this CPU
+*/
+static void _mem_choose( void ) {
+    CpuInfo info;
+
+    if( cpuinfo(&info) == SUCCESS && CPU_HAS(&info,CPU_SSE2) ) {
+        _memcopy_impl = __memcopy_sse2;
+        _memfill_impl = __memfill_sse2;
+    } else {
+        _memcopy_impl = __memcopy_rep;
+        _memfill_impl = __memfill_rep;
+    }
+}
+
+/*
+** _memcopy_first(), _memfill_first() - initial implementations
+**
+** Make the selection, then do the work with the chosen routine.
+*/
+static void _memcopy_first( void *dst, const void *src, uint32 len ) {
+    _mem_choose();
+    _memcopy_impl( dst, src, len );
+}
+
+static void _memfill_first( void *buf, uint32 len, uint32 value ) {
+    _mem_choose();
+    _memfill_impl( buf, len, value );
+}
+
 /*
 ** PUBLIC FUNCTIONS
 */
@@ -184,13 +237,8 @@ int str2int( register const char *str, register int base ) {
 ** @returns The length of the string, or 0
 */
 uint32 strlen( register const char *str ) {
-    register uint32 len = 0;
-
-    while( *str++ ) {
-        ++len;
-    }
 
-    return( len );
+    return( __strlen(str) );
 }
 
 /*
@@ -204,12 +252,8 @@ uint32 strlen( register const char *str ) {
 ** NOTE:  assumes dst is large enough to hold the copied string
 */
 char *strcpy( register char *dst, register const char *src ) {
-    register char *tmp = dst;
 
-    while( (*dst++ = *src++) )
-        ;
-
-    return( tmp );
+    return( __strcpy(dst,src) );
 }
 
 /*
@@ -244,10 +288,33 @@ char *strcat( register char *dst, register const char *src ) {
 */
 int strcmp( register const char *s1, register const char *s2 ) {
 
-    while( *s1 != 0 && (*s1 == *s2) )
-        ++s1, ++s2;
+    return( __strcmp(s1,s2) );
+}
+
+/*
+** memcopy(dst,src,len) - copy a block of memory
+**
+** @param dst The destination buffer
+** @param src The source buffer
+** @param len Number of bytes to copy
+**
+** NOTE:  may not correctly deal with overlapping buffers
+*/
+void memcopy( void *dst, const void *src, uint32 len ) {
 
-    return( *(const unsigned char *)s1 - *(const unsigned char *)s2 );
+    _memcopy_impl( dst, src, len );
+}
+
+/*
+** memfill(buf,len,value) - set all bytes of a block of memory
+**
+** @param buf   The buffer
+** @param len   Number of bytes to set
+** @param value The value to store in each byte
+*/
+void memfill( void *buf, uint32 len, uint32 value ) {
+
+    _memfill_impl( buf, len, value );
 }
 
 
@@ -401,7 +468,7 @@ void sprint( char *dst, char *fmt, ... ) {
                 break;
 
             case 'x':
-                len = cvt_hex( buf, *ap++ ) + 2;
+                len = cvt_hex( buf, *ap++ );
                 dst = padstr( dst, buf, len, width, leftadjust, padchar );
                 break;
 
@@ -427,6 +494,99 @@ void sprint( char *dst, char *fmt, ... ) {
 **********************************************
 */
 
+/*
+** fast_gettime() - retrieve the current system time without a syscall
+**
+** @returns The current system time
+**
+** Uses the time page maintained by the clock ISR.  If the TSC rate has
+** been calibrated, the TSC is used to account for any ticks which have
+** elapsed but not yet been published (e.g., while interrupts are off).
+*/
+Time fast_gettime( void ) {
+    uint32 seq, rate;
+    Time now;
+    uint64 tsc;
+
+    if( _timepage == NULL ) {
+        _timepage = timepage();
+    }
+
+    // take a consistent snapshot of the page
+    do {
+        seq = _timepage->seq;
+        now = _timepage->time;
+        tsc = _timepage->tsc;
+        rate = _timepage->tsc_per_tick;
+    } while( (seq & 1) != 0 || seq != _timepage->seq );
+
+    if( rate != 0 ) {
+        uint64 delta = rdtsc() - tsc;
+        // ignore absurd deltas (more than 2^32 cycles)
+        if( (delta >> 32) == 0 ) {
+            now += ((uint32) delta) / rate;
+        }
+    }
+
+    return( now );
+}
+
+/*
+** ring_submit(ring,code,a1,a2,a3,tag) - queue a request in a system
+**                                       call ring
+**
+** @param ring The ring
+** @param code The system call code (SYS_xxx, from syscalls.h)
+** @param a1   First argument
+** @param a2   Second argument
+** @param a3   Third argument
+** @param tag  Value to be returned in the completion
+**
+** @returns 0 on success, or E_SPACE if the submission queue is full
+*/
+int32 ring_submit( SysRing *ring, uint32 code, uint32 a1, uint32 a2,
+                   uint32 a3, uint32 tag ) {
+    uint32 tail = ring->sq_tail;
+
+    if( tail - ring->sq_head >= SYSRING_SIZE ) {
+        return( E_SPACE );
+    }
+
+    SysReq *req = &ring->sq[ tail & (SYSRING_SIZE - 1) ];
+    req->code = code;
+    req->args[0] = a1;
+    req->args[1] = a2;
+    req->args[2] = a3;
+    req->tag = tag;
+
+    // publish the request only after it has been filled in
+    ring->sq_tail = tail + 1;
+
+    return( SUCCESS );
+}
+
+/*
+** ring_reap(ring,cqe) - retrieve the next completion from a system
+**                       call ring
+**
+** @param ring The ring
+** @param cqe  Where to place the completion
+**
+** @returns true if a completion was retrieved, else false
+*/
+bool ring_reap( SysRing *ring, SysCqe *cqe ) {
+    uint32 head = ring->cq_head;
+
+    if( head == ring->cq_tail ) {
+        return( false );
+    }
+
+    *cqe = ring->cq[ head & (SYSRING_SIZE - 1) ];
+    ring->cq_head = head + 1;
+
+    return( true );
+}
+
 /*
 ** parse_args(argc,args,n,argv)
 **
@@ -576,8 +736,7 @@ int cvt_oct( char *buf, uint32 value ){
         char    *bp = buf;
         int     val;
 
-        val = ( value & 0xc0000000 );
-        val >>= 30;
+        val = ( value >> 30 ) & 0x3;
         for( i = 0; i < 11; i += 1 ){
 
                 if( i == 10 || val != 0 || chars_stored ){
@@ -585,7 +744,8 @@ int cvt_oct( char *buf, uint32 value ){
                         val &= 0x7;
                         *bp++ = val + '0';
                 }
-                value <<= 3;
+                // the first digit holds only the top two bits
+                value <<= ( i == 0 ? 2 : 3 );
                 val = ( value & 0xe0000000 );
                 val >>= 29;
         }
@@ -13,6 +13,9 @@
 #include "common.h"
 #include "users.h"
 
+// need system call codes for batched system calls
+#include "syscalls.h"
+
 /*
 ** USER PROCESSES
 **
@@ -40,6 +43,7 @@ int idle( int, char * );
 
 int main1( int, char * ); int main2( int, char * ); int main3( int, char * );
 int main4( int, char * ); int main5( int, char * ); int main6( int, char * );
+int main7( int, char * );
 
 int userA( int, char * ); int userB( int, char * ); int userC( int, char * );
 int userD( int, char * ); int userE( int, char * ); int userF( int, char * );
@@ -561,6 +565,104 @@ int main6( int argc, char *args ) {
     return( 42 );  // shut the compiler up!
 }
 
+/*
+** User function main #7:  exit, spawn, wait, write
+**
+** Spawns and reaps many short-lived children, keeping up to 'k' of
+** them alive at once, and reports the average cost of each
+** spawn()/wait() pair in TSC cycles.  A copy of main7 invoked with
+** the ID character '.' is one of those children; it exits at once.
+**
+** Invoked as:  main7 [ x [ n [ k ] ] ]
+**   where x is the ID character (defaults to '7')
+**         n is the total number of children (defaults to 1000)
+**         k is the number of live children to keep (defaults to 8)
+*/
+
+int main7( int argc, char *args ) {
+    int count = 1000;  // total number of children
+    int live = 8;      // children to keep alive at once
+    char ch = '7';     // default character to print
+    char buf[128];
+    char *argv[MAX_COMMAND_ARGS] = { NULL };
+    char *kid[3] = { "main7", ".", NULL };
+
+    // parse our command-line string
+    int n = parse_args( argc, args, MAX_COMMAND_ARGS, argv );
+
+    // process the argument(s)
+
+    if( n > 3 ) {    // "main7 x n k"
+        live = str2int( argv[3], 10 );
+    }
+
+    if( n > 2 ) {    // "main7 x n"
+        count = str2int( argv[2], 10 );
+    }
+
+    if( n > 1 ) {    // "main7 x"
+        ch = argv[1][0];
+    }
+
+    // are we one of the children?
+    if( ch == '.' ) {
+        exit( 0 );
+    }
+
+    if( live < 1 ) {
+        live = 1;
+    }
+
+    // announce our presence
+    write( CHAN_SIO, &ch, 1 );
+
+    int spawned = 0, reaped = 0, active = 0, failed = 0;
+    Time t0 = gettime();
+    uint64 start = rdtsc();
+
+    while( reaped < count ) {
+
+        // top up the set of live children
+        while( spawned < count && active < live ) {
+            Pid whom = spawn( main7, kid );
+            if( whom < 0 ) {
+                // probably out of PCBs; reap one and try again
+                ++failed;
+                break;
+            }
+            ++spawned;
+            ++active;
+        }
+
+        // collect one of them
+        int32 status;
+        Pid whom = wait( 0, &status );
+        if( whom < 0 ) {
+            sprint( buf, "User %c: wait() status %d\n", ch, whom );
+            cwrites( buf );
+            break;
+        }
+        ++reaped;
+        --active;
+
+        if( (reaped & 0x3ff) == 0 ) {
+            write( CHAN_SIO, &ch, 1 );
+        }
+    }
+
+    uint32 total = (uint32) (rdtsc() - start);
+    Time ticks = gettime() - t0;
+
+    sprint( buf, "User %c: %d children in %d ticks, avg %d cycles each,"
+            " %d spawn failures\n", ch, reaped, (uint32) ticks,
+            reaped > 0 ? total / reaped : 0, failed );
+    cwrites( buf );
+
+    exit( 0 );
+
+    return( 42 );  // shut the compiler up!
+}
+
 /*
 ** User function H:  write, spawn, sleep
 **
@@ -785,6 +887,106 @@ int userJ( int argc, char *args ) {
     return( 42 );  // shut the compiler up!
 }
 
+/*
+** User function O:  write, getpid, ringsetup, ringenter, exit
+**
+** Reports itself, then measures the cost of a getpid() round trip
+** (in TSC cycles) over several runs, reporting the best and average
+** cost for each run.  Finally, measures the average cost of getpid()
+** when issued in batches through a system call ring.
+**
+** Invoked as:  userO [ x [ n [ r ] ] ]
+**   where x is the ID character (defaults to 'o')
+**         n is the number of calls per run (defaults to 1000)
+**         r is the number of runs (defaults to 5)
+*/
+
+int userO( int argc, char *args ) {
+    int n;
+    int count = 1000; // calls per run
+    int runs = 5;     // number of runs
+    char ch = 'o';    // default character to print
+    char buf[128];
+    char *argv[MAX_COMMAND_ARGS] = { NULL };
+
+    // parse our command-line string
+    n = parse_args( argc, args, MAX_COMMAND_ARGS, argv );
+
+    // process the argument(s)
+
+    if( n > 3 ) {    // "userO x n r"
+        runs = str2int( argv[3], 10 );
+    }
+
+    if( n > 2 ) {    // "userO x n"
+        count = str2int( argv[2], 10 );
+    }
+
+    if( n > 1 ) {    // "userO x"
+        ch = argv[1][0];
+    }
+
+    if( count < 1 ) {
+        count = 1;
+    }
+
+    // announce our presence
+    write( CHAN_SIO, &ch, 1 );
+
+    for( int r = 0; r < runs; ++r ) {
+        uint32 best = 0xffffffff;
+        uint64 start = rdtsc();
+
+        for( int i = 0; i < count; ++i ) {
+            uint64 t0 = rdtsc();
+            (void) getpid();
+            uint32 cycles = (uint32) (rdtsc() - t0);
+            if( cycles < best ) {
+                best = cycles;
+            }
+        }
+
+        uint32 total = (uint32) (rdtsc() - start);
+        sprint( buf, "User %c: getpid() best %d avg %d cycles\n",
+                ch, best, total / count );
+        cwrites( buf );
+        write( CHAN_SIO, &ch, 1 );
+    }
+
+    // now, the same thing in batches of SYSRING_SIZE calls
+    static SysRing ring;
+    SysCqe cqe;
+
+    if( ringsetup(&ring) != SUCCESS ) {
+        cwrites( "User O: ringsetup() failed\n" );
+        exit( 1 );
+    }
+
+    int done = 0;
+    uint64 start = rdtsc();
+    while( done < count ) {
+        int batch = 0;
+        while( batch < SYSRING_SIZE && done + batch < count &&
+               ring_submit(&ring,SYS_getpid,0,0,0,batch) == SUCCESS ) {
+            ++batch;
+        }
+        (void) ringenter();
+        while( ring_reap(&ring,&cqe) ) {
+            ++done;
+        }
+    }
+    uint32 total = (uint32) (rdtsc() - start);
+    sprint( buf, "User %c: batched getpid() avg %d cycles\n",
+            ch, total / count );
+    cwrites( buf );
+
+    (void) ringsetup( NULL );
+
+    exit( 0 );
+
+    return( 42 );  // shut the compiler up!
+}
+
 /*
 ** User function P:  write, gettime, sleep
 **
@@ -1449,7 +1651,21 @@ int init( int argc, char *args ) {
     swritech( ch );
 #endif
 
-    // There is no user O
+    // User O measures the cost of a getpid() call
+
+#ifdef SPAWN_O
+    // "userO O 1000 5"
+    argv[0] = "userO";
+    argv[1] = "O";
+    argv[2] = "1000";
+    argv[3] = "5";
+    argv[4] = NULL;
+    whom = spawn( userO, argv );
+    if( whom < 0 ) {
+        cwrites( "init, spawn() user O failed\n" );
+    }
+    swritech( ch );
+#endif
 
     // User P iterates, reporting system time and sleeping
 
@@ -1559,6 +1775,22 @@ int init( int argc, char *args ) {
     swritech( ch );
 #endif
 
+    // User 7 spawns and reaps lots of short-lived children
+
+#ifdef SPAWN_7
+    // "main7 7 1000 8"
+    argv[0] = "main7";
+    argv[1] = "7";
+    argv[2] = "1000";
+    argv[3] = "8";
+    argv[4] = NULL;
+    whom = spawn( main7, argv );
+    if( whom < 0 ) {
+        cwrites( "init, spawn() user 7 failed\n" );
+    }
+    swritech( ch );
+#endif
+
     // Users W through Z are spawned elsewhere
 
     swrites( "!\r\n\n" );
@@ -71,7 +71,7 @@
 //#define SPAWN_L
 //#define SPAWN_M // M and N run main5(); they spawn userW and userZ
 //#define SPAWN_N
-// no user O
+//#define SPAWN_O // O times getpid() round trips, direct and batched
 //#define SPAWN_P // P iterates, reporting system time and sleeping
 //#define SPAWN_Q // Q makes a bogus system call
 //#define SPAWN_R // R loops forever, reading one byte at a time from SIO
@@ -79,6 +79,7 @@
 //#define SPAWN_T // T runs main6(), spawns children, waits for them
 //#define SPAWN_U // U runs main6(), spawns children, waits for them by PID
 //#define SPAWN_V // V runs main6(), spawns children, kills them
+//#define SPAWN_7 // 7 runs main7(); spawns and reaps thousands of children
 
 //
 // Users W-Z are spawned from other processes; they
@@ -104,10 +105,12 @@
 // main4    X    .    .    X     .    X     X    .    X    .    .     .
 // main5    X    .    .    X     .    X     .    .    .    .    .     .
 // main6    X    X    X    X     .    X     .    .    .    .    .     .
+// main7    X    X    .    X     .    X     .    X    .    .    .     .
 //
 // userH    X    .    .    X     .    X     X    .    .    .    .     .
 // userI    X    .    X    X     .    X     X    .    X    .    X     .
 // userJ    X    .    .    X     .    X     .    .    X    .    .     .
+// userO    X    .    .    .     .    X     .    .    X    .    .     .
 // userP    X    .    .    .     .    X     X    X    .    .    .     .
 // userQ    X    .    .    .     .    X     .    .    .    .    .     X
 // userR    X    .    .    .     X    X     X    .    .    .    .     .
@@ -0,0 +1,139 @@
+/*
+** SCCS ID:	@(#)wstring.c	1.1	3/30/20
+**
+** File:	wstring.c
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Word-at-a-time string routines
+*/
+
+#include "wstring.h"
+
+/*
+** PRIVATE DEFINITIONS
+*/
+
+// does this word contain a NUL byte?
+
+#define	HAS_NUL(w)	((((w) - 0x01010101) & ~(w) & 0x80808080) != 0)
+
+// is this pointer word-aligned?
+
+#define	ALIGNED(p)	(((uint32) (p) & 3) == 0)
+
+/*
+** PRIVATE DATA TYPES
+*/
+
+// a word which may alias the characters of a string
+
+typedef uint32 __attribute__((may_alias)) Word;
+
+/*
+** PUBLIC FUNCTIONS
+*/
+
+/*
+** Name:        __strlen
+**
+** Description: Calculate the length of a C-style string.
+**
+** @param str  The string to examine
+**
+** @returns The length of the string
+*/
+uint32 __strlen( register const char *str ) {
+	register const char *p = str;
+
+	// bytes up to the first word boundary
+	while( !ALIGNED(p) ) {
+		if( *p == 0 ) {
+			return( p - str );
+		}
+		++p;
+	}
+
+	// whole words, until one contains the NUL
+	while( !HAS_NUL(*(const Word *) p) ) {
+		p += 4;
+	}
+
+	// find it within that word
+	while( *p ) {
+		++p;
+	}
+
+	return( p - str );
+}
+
+/*
+** Name:        __strcmp
+**
+** Description: Compare two strings
+**
+** @param s1   The first string to examine
+** @param s2   The second string to examine
+**
+** @returns < 0 if s1 < s2; 0 if equal; > 0 if s1 > s2
+*/
+int __strcmp( register const char *s1, register const char *s2 ) {
+
+	// words can only be compared if the strings are aligned alike
+	if( (((uint32) s1 ^ (uint32) s2) & 3) == 0 ) {
+		while( !ALIGNED(s1) ) {
+			if( *s1 == 0 || *s1 != *s2 ) {
+				goto bytes;
+			}
+			++s1, ++s2;
+		}
+		while( *(const Word *) s1 == *(const Word *) s2 &&
+		       !HAS_NUL(*(const Word *) s1) ) {
+			s1 += 4, s2 += 4;
+		}
+	}
+
+bytes:
+	// finish (or do the whole job) a byte at a time
+	while( *s1 != 0 && (*s1 == *s2) )
+		++s1, ++s2;
+
+	return( *(const uint8 *)s1 - *(const uint8 *)s2 );
+}
+
+/*
+** Name:        __strcpy
+**
+** Description: Copy a string into a destination buffer
+**
+** May not correctly deal with overlapping buffers
+**
+** @param dst   The destination buffer
+** @param src   The source buffer
+**
+** @returns The destination buffer
+*/
+char *__strcpy( register char *dst, register const char *src ) {
+	char *tmp = dst;
+
+	// words can only be copied if the buffers are aligned alike
+	if( (((uint32) dst ^ (uint32) src) & 3) == 0 ) {
+		while( !ALIGNED(src) ) {
+			if( (*dst++ = *src++) == 0 ) {
+				return( tmp );
+			}
+		}
+		while( !HAS_NUL(*(const Word *) src) ) {
+			*(Word *) dst = *(const Word *) src;
+			dst += 4, src += 4;
+		}
+	}
+
+	// the last word (or the whole string) a byte at a time
+	while( (*dst++ = *src++) )
+		;
+
+	return( tmp );
+}
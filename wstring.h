@@ -0,0 +1,79 @@
+/*
+** SCCS ID:	@(#)wstring.h	1.1	3/30/20
+**
+** File:	wstring.h
+**
+** Author:	CSCI-452 class of 20195
+**
+** Contributor:
+**
+** Description:	Word-at-a-time string routines
+**
+** These are shared by the kernel library (where they are the __str*()
+** functions) and the user library (where strlen(), strcmp() and
+** strcpy() call them).  Wherever the alignment of the strings allows
+** it, they examine four bytes at a time, using the usual trick to
+** find a NUL byte within a word.  Aligned words never cross a page
+** boundary, so reading a whole word which extends past the NUL at the
+** end of a string is harmless.
+*/
+
+#ifndef _WSTRING_H_
+#define _WSTRING_H_
+
+#include "types.h"
+
+/*
+** General (C and/or assembly) definitions
+*/
+
+#ifndef __SP_ASM__
+
+/*
+** Start of C-only definitions
+*/
+
+/*
+** Prototypes
+*/
+
+/*
+** Name:        __strlen
+**
+** Description: Calculate the length of a C-style string.
+**
+** @param str  The string to examine
+**
+** @returns The length of the string
+*/
+uint32 __strlen( register const char *str );
+
+/*
+** Name:        __strcmp
+**
+** Description: Compare two strings
+**
+** @param s1   The first string to examine
+** @param s2   The second string to examine
+**
+** @returns < 0 if s1 < s2; 0 if equal; > 0 if s1 > s2
+*/
+int __strcmp( register const char *s1, register const char *s2 );
+
+/*
+** Name:        __strcpy
+**
+** Description: Copy a string into a destination buffer
+**
+** May not correctly deal with overlapping buffers
+**
+** @param dst   The destination buffer
+** @param src   The source buffer
+**
+** @returns The destination buffer
+*/
+char *__strcpy( register char *dst, register const char *src );
+
+#endif
+
+#endif